@@ -0,0 +1,85 @@
+#include <Arena.h>
+#include <new>
+
+Arena::~Arena () {
+    this->release();
+}
+
+/**
+ * Hands out size bytes aligned to alignment, growing the arena by a chunk if the last one has no room for them.
+ * @param size
+ * @param alignment A power of two, no larger than alignof(std::max_align_t).
+ * @return
+ */
+void* Arena::allocate (const size_t size, const size_t alignment) {
+    auto aligned = (char*) (((uintptr_t) this->cursor + alignment - 1) & ~(uintptr_t) (alignment - 1));
+
+    if (this->cursor == nullptr || aligned > this->limit || size > (size_t) (this->limit - aligned)) {
+        this->grow(size + alignment);
+        aligned = (char*) (((uintptr_t) this->cursor + alignment - 1) & ~(uintptr_t) (alignment - 1));
+    }
+
+    this->cursor = aligned + size;
+    return aligned;
+}
+
+/**
+ * Makes all the memory of the arena free again. Whatever was allocated from it must not be used after this.
+ */
+void Arena::reset () {
+    if (this->last == nullptr) {
+        return;
+    }
+
+    if (this->last->previous != nullptr) {
+        size_t capacity = this->get_capacity();
+        this->release();
+        this->grow(capacity);
+        return;
+    }
+
+    this->cursor = (char*) (this->last + 1);
+}
+
+/**
+ * @return The number of bytes in all the chunks of the arena, used or not.
+ */
+size_t Arena::get_capacity () const {
+    size_t rv = 0;
+    for (auto chunk = this->last; chunk != nullptr; chunk = chunk->previous) {
+        rv += chunk->size;
+    }
+    return rv;
+}
+
+/**
+ * Frees every chunk.
+ */
+void Arena::release () {
+    while (this->last != nullptr) {
+        arena_chunk_t* previous = this->last->previous;
+        ::operator delete(this->last);
+        this->last = previous;
+    }
+    this->cursor = nullptr;
+    this->limit = nullptr;
+}
+
+/**
+ * Adds a chunk with room for at least size bytes, which allocations carry on from.
+ * @param size
+ */
+void Arena::grow (const size_t size) {
+    size_t chunk_size = this->last != nullptr ? this->last->size * 2 : ARENA_CHUNK_SIZE;
+    while (chunk_size < size + sizeof(arena_chunk_t)) {
+        chunk_size *= 2;
+    }
+
+    auto chunk = (arena_chunk_t*) ::operator new(chunk_size);
+    chunk->previous = this->last;
+    chunk->size = chunk_size;
+
+    this->last = chunk;
+    this->cursor = (char*) (chunk + 1);
+    this->limit = (char*) chunk + chunk_size;
+}
@@ -0,0 +1,132 @@
+#include <BatchTokenizer.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+template <typename CharT>
+BasicBatchTokenizer<CharT>::BasicBatchTokenizer (int log_handler (const char*, ...), const size_t jobs)
+        : log_handler(log_handler), jobs(jobs ? jobs : std::max(1u, std::thread::hardware_concurrency())) {}
+
+/**
+ * Tokenizes and renders every file, and passes the results to the sink in order.
+ * Workers pick up the next file as soon as they are done with their last one, as long as they do not get more than
+ * the window ahead of the sink. The sink runs on the calling thread, and must not throw.
+ * @param file_names
+ * @param renderer
+ * @param sink
+ * @return The number of files that failed.
+ */
+template <typename CharT>
+size_t BasicBatchTokenizer<CharT>::run (const std::vector<std::string>& file_names, const renderer_t& renderer,
+                                        const sink_t& sink) {
+    typedef struct {
+        std::string output;
+        err_t error;
+        memory_usage_t memory;  // All zero if the file failed.
+        bool done;
+    } batch_result_t;
+
+    const size_t n = file_names.size();
+    const size_t window = this->jobs * BATCH_WINDOW_PER_JOB;
+
+    std::vector<batch_result_t> results(n);
+    std::mutex mutex;
+    std::condition_variable changed;  // Notified whenever a result is done, or one has been handed to the sink.
+    size_t next = 0;  // The next file a worker should pick up.
+    size_t emitted = 0;  // How many files have been handed to the sink.
+
+    auto worker = [&] () {
+        std::optional<BasicTokenizer<CharT>> tokenizer;
+
+        while (true) {
+            size_t i;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return next >= n || next < emitted + window; });
+                if (next >= n) {
+                    return;
+                }
+                i = next++;
+            }
+
+            // A tokenizer that failed may have been left mid-way, so every file after an error gets a fresh one.
+            if (!tokenizer.has_value()) {
+                tokenizer.emplace(this->log_handler);
+                tokenizer->set_cache(this->cache);
+            }
+
+            std::string output;
+            err_t error = SUCCESS;
+            memory_usage_t memory = {0, 0, 0, 0, 0, 0};
+
+            Result<root_t> root = tokenizer->tokenize(file_names[i].c_str());
+            if (root) {
+                // The renderer is the caller's, and may still throw when built with exceptions.
+#ifdef M6_EXCEPTIONS
+                try {
+                    output = renderer(*root);
+                } catch (const err_t e) {
+                    error = e;
+                } catch (...) {
+                    error = ERR_UNEXPECTED_EXCEPTION;
+                }
+#else
+                output = renderer(*root);
+#endif
+                if (error == SUCCESS) {
+                    memory = root->memory_usage();
+                }
+            } else {
+                error = root.get_error();
+            }
+
+            if (error != SUCCESS) {
+                tokenizer.reset();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                results[i] = {std::move(output), error, memory, true};
+            }
+            changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t j = 0; j < std::min(this->jobs, n); ++j) {
+        workers.emplace_back(worker);
+    }
+
+    size_t failures = 0;
+    for (size_t i = 0; i < n; ++i) {
+        batch_result_t result;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return results[i].done; });
+            result = std::move(results[i]);
+            emitted = i + 1;
+        }
+        changed.notify_all();
+
+        failures += result.error != SUCCESS;
+        sink(file_names[i], result.output, result.error, result.memory);
+    }
+
+    for (auto& worker_thread: workers) {
+        worker_thread.join();
+    }
+
+    return failures;
+}
+
+/**
+ * Sets a cache for every worker to look files up in before lexing them. The cache is not owned.
+ * @param cache
+ */
+template <typename CharT>
+void BasicBatchTokenizer<CharT>::set_cache (BasicTokenCache<CharT>* cache) {
+    this->cache = cache;
+}
+
+template class BasicBatchTokenizer<char16_t>;
+template class BasicBatchTokenizer<char>;
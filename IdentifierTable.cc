@@ -0,0 +1,125 @@
+#include <IdentifierTable.h>
+#include <hash.h>
+
+template <typename CharT>
+BasicIdentifierTable<CharT>::BasicIdentifierTable (Arena* arena) : pool(arena), ends(arena), slots(arena) {}
+
+/**
+ * Looks an identifier up, and copies it into the pool if it is not there yet.
+ * @param identifier
+ * @return The id of the identifier.
+ */
+template <typename CharT>
+uint32_t BasicIdentifierTable<CharT>::intern (const std::basic_string_view<CharT> identifier) {
+    if (this->slots.empty()) {
+        this->rehash(IDENTIFIER_TABLE_SLOTS);
+    }
+
+    const size_t mask = this->slots.size() - 1;
+    size_t slot = hash(identifier) & mask;
+
+    for (; this->slots[slot] != EMPTY_SLOT; slot = (slot + 1) & mask) {
+        if ((*this)[this->slots[slot]] == identifier) {
+            return this->slots[slot];
+        }
+    }
+
+    if ((uint64_t) this->pool.size() + identifier.size() > UINT32_MAX) {
+        fail(ERR_INPUT_TOO_LARGE);
+    }
+
+    const auto id = (uint32_t) this->ends.size();
+    this->pool.insert(this->pool.end(), identifier.begin(), identifier.end());
+    this->ends.push_back((uint32_t) this->pool.size());
+    this->slots[slot] = id;
+
+    if (this->ends.size() * 2 > this->slots.size()) {
+        this->rehash(this->slots.size() * 2);
+    }
+
+    return id;
+}
+
+/**
+ * @param id
+ * @return The identifier with that id, which is only valid until the next identifier is interned.
+ */
+template <typename CharT>
+std::basic_string_view<CharT> BasicIdentifierTable<CharT>::operator[] (const uint32_t id) const {
+    const uint32_t begin = id != 0 ? this->ends[id - 1] : 0;
+    return std::basic_string_view<CharT>(this->pool.data() + begin, this->ends[id] - begin);
+}
+
+template <typename CharT>
+size_t BasicIdentifierTable<CharT>::size () const {
+    return this->ends.size();
+}
+
+template <typename CharT>
+bool BasicIdentifierTable<CharT>::empty () const {
+    return this->ends.empty();
+}
+
+/**
+ * Makes room for identifier_count identifiers with code_unit_count code units between them, for when they are all
+ * known up front.
+ * @param identifier_count
+ * @param code_unit_count
+ */
+template <typename CharT>
+void BasicIdentifierTable<CharT>::reserve (const size_t identifier_count, const size_t code_unit_count) {
+    this->pool.reserve(code_unit_count);
+    this->ends.reserve(identifier_count);
+
+    size_t slot_count = IDENTIFIER_TABLE_SLOTS;
+    while (slot_count < identifier_count * 2 + 2) {
+        slot_count *= 2;
+    }
+    if (slot_count > this->slots.size()) {
+        this->rehash(slot_count);
+    }
+}
+
+/**
+ * Forgets every identifier, but keeps the memory they took.
+ */
+template <typename CharT>
+void BasicIdentifierTable<CharT>::clear () {
+    this->pool.clear();
+    this->ends.clear();
+    std::fill(this->slots.begin(), this->slots.end(), EMPTY_SLOT);
+}
+
+/**
+ * @return The bytes that the identifiers take in the pool, along with their ends and the hash table.
+ */
+template <typename CharT>
+size_t BasicIdentifierTable<CharT>::get_size_in_bytes () const {
+    return this->pool.size() * sizeof(CharT) + (this->ends.size() + this->slots.size()) * sizeof(uint32_t);
+}
+
+template <typename CharT>
+size_t BasicIdentifierTable<CharT>::hash (const std::basic_string_view<CharT> identifier) {
+    return (size_t) hash_bytes(identifier.data(), identifier.size() * sizeof(CharT), 0);
+}
+
+/**
+ * Replaces the hash table by one with slot_count slots, and puts every id back into it.
+ * @param slot_count A power of two, more than twice the number of identifiers.
+ */
+template <typename CharT>
+void BasicIdentifierTable<CharT>::rehash (const size_t slot_count) {
+    this->slots.assign(slot_count, EMPTY_SLOT);
+
+    const size_t mask = slot_count - 1;
+    for (uint32_t id = 0; id < this->ends.size(); ++id) {
+        size_t slot = hash((*this)[id]) & mask;
+        while (this->slots[slot] != EMPTY_SLOT) {
+            slot = (slot + 1) & mask;
+        }
+        this->slots[slot] = id;
+    }
+}
+
+template class BasicIdentifierTable<char16_t>;
+template class BasicIdentifierTable<char>;
@@ -0,0 +1,213 @@
+#include <IncrementalTokenizer.h>
+
+template <typename CharT>
+BasicIncrementalTokenizer<CharT>::BasicIncrementalTokenizer (int log_handler (const char*, ...))
+        : BasicTokenizer<CharT>(log_handler) {}
+
+/**
+ * Takes a copy of a buffer, and tokenizes all of it.
+ * @param str
+ * @return The root, which stays valid until the next edit, or the error that the buffer ran into.
+ */
+template <typename CharT>
+Result<typename BasicIncrementalTokenizer<CharT>::root_t*>
+BasicIncrementalTokenizer<CharT>::tokenize (std::basic_string_view<CharT> str) {
+    this->content.assign(str.data(), str.size());
+    this->root.reset();
+    this->reported = 0;
+
+    Result<root_t> rv = BasicTokenizer<CharT>::tokenize(std::basic_string_view<CharT>(this->content));
+    if (!rv) {
+        return failure_t {rv.get_error()};
+    }
+
+    this->root.emplace(std::move(*rv));
+    this->reported = this->root->token_vector.size();
+
+    return &*this->root;
+}
+
+/**
+ * Replaces removed code units at offset with the inserted ones, and lexes the buffer again around the edit.
+ * @param offset
+ * @param removed
+ * @param inserted
+ * @return Which tokens of the root changed, or ERR_INVALID_EDIT and ERR_INPUT_TOO_LARGE for an edit that was not
+ *         applied, or the error that the edited buffer ran into, which leaves no tokens until an edit fixes it.
+ */
+template <typename CharT>
+Result<token_diff_t> BasicIncrementalTokenizer<CharT>::edit (const size_t offset, const size_t removed,
+                                                             std::basic_string_view<CharT> inserted) {
+    if (offset > this->content.size() || removed > this->content.size() - offset) {
+        return failure_t {ERR_INVALID_EDIT};
+    }
+    if (this->content.size() - removed + inserted.size() > MAX_INPUT_SIZE) {
+        return failure_t {ERR_INPUT_TOO_LARGE};
+    }
+
+    // After a syntax error, there are no tokens to go on, so the whole buffer has to be tokenized again.
+    if (!this->root.has_value()) {
+        this->content.replace(offset, removed, inserted.data(), inserted.size());
+        Result<root_t> tokenized = BasicTokenizer<CharT>::tokenize(std::basic_string_view<CharT>(this->content));
+        if (!tokenized) {
+            return failure_t {tokenized.get_error()};
+        }
+        this->root.emplace(std::move(*tokenized));
+
+        token_diff_t rv = {0, this->reported, this->root->token_vector.size()};
+        this->reported = rv.inserted;
+        return rv;
+    }
+
+    auto& tokens = this->root->token_vector;
+    const CharT* old_data = this->content.data();
+    const auto edit_end = (std::ptrdiff_t) (offset + removed);
+
+    // A token that ends far enough before the edit that the lexer could not have looked into it is not affected.
+    size_t restart = std::partition_point(tokens.begin(), tokens.end(), [&] (token_t token) {
+        auto text = token.get_text();
+        return text.data() + text.size() - old_data + LEXER_LOOKAHEAD <= (std::ptrdiff_t) offset;
+    }) - tokens.begin();
+
+    // An exponent leaves the lexer expecting a number, so we can only start over from anything else.
+    while (restart > 0 && tokens[restart - 1].get_type() == NUMBER &&
+           (tokens[restart - 1].get_subtype() == FLOAT_E || tokens[restart - 1].get_subtype() == FLOAT_NE)) {
+        --restart;
+    }
+
+    // Lexing starts over from the first affected token, or after the last token if none is.
+    const std::ptrdiff_t restart_offset =
+            restart < tokens.size() ? tokens.get_offset(restart) :
+            !tokens.empty() ? tokens.get_offset(tokens.size() - 1) + tokens.get_length(tokens.size() - 1) : 0;
+
+    // The tail is every token after the edit, which the new tokens may line up with again.
+    const size_t tail_begin = std::partition_point(tokens.begin() + restart, tokens.end(), [&] (token_t token) {
+        return token.get_text().data() - old_data < edit_end;
+    }) - tokens.begin();
+
+    // The lookbehind of the new tokens never gets past the last token before them that it stops at.
+    size_t history_begin = restart;
+    while (history_begin > 0 && !stops_lookbehind(tokens[--history_begin]));
+
+    this->content.replace(offset, removed, inserted.data(), inserted.size());
+
+    // The buffer may have been moved, and everything after the edit moved by how much it grew.
+    const CharT* new_data = this->content.data();
+    const std::ptrdiff_t grown = (std::ptrdiff_t) inserted.size() - (std::ptrdiff_t) removed;
+
+    tokens.set_base(new_data);
+    tokens.shift(tail_begin, tokens.size(), grown);
+
+    // The new tokens are lexed into a root of their own, after a copy of the history they may need, and then
+    // spliced in. The identifiers are lent to it, so that new ones end up with the rest.
+    auto scratch = root_t(ROOT, UNDEFINED, new_data, new_data + this->content.size(), token_value_t::none());
+    scratch.token_vector.reserve(restart - history_begin + TOKEN_VECTOR_RESERVE);
+    for (auto i = history_begin; i < restart; ++i) {
+        scratch.token_vector.push_back(tokens[i]);
+    }
+    scratch.identifiers = std::move(this->root->identifiers);
+
+    const size_t seeded = scratch.token_vector.size();
+
+    this->base_token = &scratch;
+    this->tokenizer_iterator = new_data + restart_offset;
+    this->suspended_range.reset();
+    this->expecting_iterator = 0;
+    this->expect(ANYTHING);
+
+    // Once a new token is the same as a tail token, and the lookbehind cannot get past it, every token after it
+    // would be lexed the same way as before, so the rest of the tail is kept.
+    size_t candidate = tail_begin;
+    bool lined_up = false;
+
+    Result<bool> processed = true;
+    while ((processed = this->process_next_token()) && *processed) {
+        auto token = scratch.token_vector.back();
+
+        while (candidate < tokens.size() &&
+               (std::ptrdiff_t) tokens.get_offset(candidate) < token.get_text().data() - new_data) {
+            ++candidate;
+        }
+
+        if (candidate < tokens.size() && same_token(tokens[candidate], token) && stops_lookbehind(token)) {
+            lined_up = true;
+            break;
+        }
+    }
+
+    // The identifiers go back before anything else, as they were allocated from the arena of the root.
+    this->root->identifiers = std::move(scratch.identifiers);
+
+    const bool complete = processed && (lined_up || this->get_char_offset() == NOT_FOUND);
+    this->base_token = nullptr;
+
+    if (!complete) {
+        this->root.reset();
+        return failure_t {processed ? ERR_TOKENIZING_SYNTAX_ERROR : processed.get_error()};
+    }
+
+    auto& lexed = scratch.token_vector;
+    const size_t lexed_count = lexed.size() - seeded;
+    const size_t replaced_end = lined_up ? candidate + 1 : tokens.size();
+
+    // The first few tokens that were lexed again may well have come out the same as before the edit.
+    size_t same = 0;
+    while (restart + same < tail_begin && same < lexed_count &&
+           tokens.get_offset(restart + same) + tokens.get_length(restart + same) <= offset &&
+           same_token(tokens[restart + same], lexed[seeded + same])) {
+        ++same;
+    }
+
+    const size_t first = restart + same;
+    const size_t old_count = replaced_end - first;
+    const size_t new_count = lexed_count - same;
+    const size_t overwritten = std::min(old_count, new_count);
+
+    // Only a change in the number of tokens moves the tokens after them.
+    for (size_t i = 0; i < overwritten; ++i) {
+        tokens.set(first + i, lexed[seeded + same + i]);
+    }
+    if (new_count > old_count) {
+        tokens.insert(first + old_count, lexed, seeded + same + overwritten, lexed.size());
+    } else {
+        tokens.erase(first + new_count, replaced_end);
+    }
+
+    // The root itself is kept, along with its arena, and only made to range over the new content.
+    static_cast<token_t&>(*this->root) =
+            token_t(ROOT, UNDEFINED, new_data, new_data + this->content.size(), token_value_t::none());
+    this->root->lines.clear();  // The lines have moved, so they are found again once a position is asked for.
+
+    this->reported = this->root->token_vector.size();
+    return token_diff_t {first, old_count, new_count};
+}
+
+template <typename CharT>
+typename BasicIncrementalTokenizer<CharT>::root_t& BasicIncrementalTokenizer<CharT>::get_root () {
+    return *this->root;
+}
+
+template <typename CharT>
+std::basic_string_view<CharT> BasicIncrementalTokenizer<CharT>::get_content () const {
+    return this->content;
+}
+
+template <typename CharT>
+bool BasicIncrementalTokenizer<CharT>::same_token (const token_t& a, const token_t& b) {
+    return a.get_text().data() == b.get_text().data() && a.get_text().size() == b.get_text().size() &&
+           a.get_type() == b.get_type() && a.get_subtype() == b.get_subtype();
+}
+
+/**
+ * Whether next_token_is_regex stops at this token when looking behind (see Token::cannot_precede_division),
+ * so that whatever comes after it is lexed the same way no matter what comes before it.
+ * @param token
+ * @return
+ */
+template <typename CharT>
+bool BasicIncrementalTokenizer<CharT>::stops_lookbehind (token_t token) {
+    return !token.is_discardable() && token.cannot_precede_division().has_value();
+}
+
+template class BasicIncrementalTokenizer<char16_t>;
+template class BasicIncrementalTokenizer<char>;
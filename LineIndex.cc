@@ -0,0 +1,163 @@
+#include <LineIndex.h>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__SSE2__)
+#define LINE_INDEX_X86
+#include <immintrin.h>
+#endif
+
+// Skippers return the length of the longest prefix of src that they can prove holds no code unit that may start a
+// line terminator. They may stop early (at a block boundary); the caller looks at whatever is left one at a time.
+
+#ifdef LINE_INDEX_X86
+
+static size_t skip_ordinary (const char* const src, const size_t n) {
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lead = _mm_set1_epi8((char) 0xe2);  // The first byte of U+2028 and U+2029.
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*) (src + i));
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr)),
+                                    _mm_cmpeq_epi8(v, lead));
+        if (int mask = _mm_movemask_epi8(hits)) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+
+    return i;
+}
+
+static size_t skip_ordinary (const char16_t* const src, const size_t n) {
+    const __m128i lf = _mm_set1_epi16('\n');
+    const __m128i cr = _mm_set1_epi16('\r');
+    const __m128i separator = _mm_set1_epi16(0x20'28);  // U+2028 and U+2029 only differ in the lowest bit.
+    const __m128i low_bit = _mm_set1_epi16((short) 0xff'fe);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*) (src + i));
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi16(v, lf), _mm_cmpeq_epi16(v, cr)),
+                                    _mm_cmpeq_epi16(_mm_and_si128(v, low_bit), separator));
+        if (int mask = _mm_movemask_epi8(hits)) {
+            return i + __builtin_ctz(mask) / 2;
+        }
+    }
+
+    return i;
+}
+
+#else
+
+// Every code unit that may start a line terminator is below 0x0e or has its high bit set (0xe2), so a word with
+// neither in it is skipped whole.
+static size_t skip_ordinary (const char* const src, const size_t n) {
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, src + i, 8);
+        // Sets the high bit of every byte below 0x0e, along with those that already had it set.
+        if (((word - 0x0e'0e'0e'0e'0e'0e'0e'0eu) | word) & 0x80'80'80'80'80'80'80'80u) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+static size_t skip_ordinary (const char16_t* const src, const size_t n) {
+    size_t i = 0;
+
+    for (; i < n && src[i] > '\r' && (src[i] & 0xff'feu) != 0x20'28; ++i);
+
+    return i;
+}
+
+#endif
+
+template <typename CharT>
+BasicLineIndex<CharT>::BasicLineIndex (Arena* arena) : line_starts(arena) {}
+
+/**
+ * Finds where every line of text starts. Offsets are in code units from the start of text.
+ * @param text
+ */
+template <typename CharT>
+void BasicLineIndex<CharT>::build (const std::basic_string_view<CharT> text) {
+    this->line_starts.clear();
+    this->line_starts.push_back(0);
+
+    const CharT* data = text.data();
+    const size_t n = text.size();
+
+    for (size_t i = 0; i < n; ++i) {
+        i += skip_ordinary(data + i, n - i);
+        if (i == n) {
+            break;
+        }
+
+        const auto c = (char16_t) (std::make_unsigned_t<CharT>) data[i];
+        if (c == '\n' || (c == '\r' && (i + 1 == n || data[i + 1] != '\n'))) {
+            this->line_starts.push_back((uint32_t) (i + 1));
+        } else if constexpr (std::is_same_v<CharT, char>) {
+            if (c == 0xe2 && i + 2 < n && (uint8_t) data[i + 1] == 0x80 && ((uint8_t) data[i + 2] & 0xfeu) == 0xa8) {
+                i += 2;
+                this->line_starts.push_back((uint32_t) (i + 1));
+            }
+        } else if ((c & 0xff'feu) == 0x20'28) {
+            this->line_starts.push_back((uint32_t) (i + 1));
+        }
+    }
+}
+
+/**
+ * Forgets the line starts, for when the text they were found in has changed.
+ */
+template <typename CharT>
+void BasicLineIndex<CharT>::clear () {
+    this->line_starts.clear();
+}
+
+/**
+ * @return Whether the index has not been built yet.
+ */
+template <typename CharT>
+bool BasicLineIndex<CharT>::empty () const {
+    return this->line_starts.empty();
+}
+
+/**
+ * @param offset In code units from the start of the text.
+ * @return The line and column of the code unit at offset.
+ */
+template <typename CharT>
+text_position_t BasicLineIndex<CharT>::find (const size_t offset) const {
+    auto next_line = std::upper_bound(this->line_starts.begin(), this->line_starts.end(), offset);
+    auto line = (uint32_t) (next_line - this->line_starts.begin());
+    return {line, (uint32_t) (offset - *(next_line - 1) + 1)};
+}
+
+template <typename CharT>
+size_t BasicLineIndex<CharT>::get_line_count () const {
+    return this->line_starts.size();
+}
+
+/**
+ * @param line Counted from 1.
+ * @return The offset at which the line starts.
+ */
+template <typename CharT>
+uint32_t BasicLineIndex<CharT>::get_line_start (const uint32_t line) const {
+    return this->line_starts[line - 1];
+}
+
+template <typename CharT>
+size_t BasicLineIndex<CharT>::get_size_in_bytes () const {
+    return this->line_starts.size() * sizeof(uint32_t);
+}
+
+template class BasicLineIndex<char16_t>;
+template class BasicLineIndex<char>;
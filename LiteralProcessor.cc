@@ -1,4 +1,5 @@
 #include <LiteralProcessor.h>
+#include <scan.h>
 
 // TODO: https://github.com/mtsoltan/m6/issues/1
 
@@ -8,30 +9,36 @@
  * with anything being after them.
  * @param t
  */
-void LiteralProcessor::expect (const token_type_t t) {
+template <typename CharT>
+void LiteralProcessor<CharT>::expect (const token_type_t t) {
     // If we expect more than 4 times in a row before unexpecting, then we overflow and crash.
     this->expecting[this->expecting_iterator++] = t;
 }
 
-token_type_t LiteralProcessor::unexpect () {
+template <typename CharT>
+token_type_t LiteralProcessor<CharT>::unexpect () {
     // If we unexpect when we don't have anything expected, then we underflow and crash.
     return this->expecting[--this->expecting_iterator];
 }
 
-bool LiteralProcessor::process_keyword (const opcode_t memoized) {
+template <typename CharT>
+bool LiteralProcessor<CharT>::process_keyword (const opcode_t memoized) {
 // If we have a memoized keyword, then just generate a token from that.
     if (memoized & OP_KEYWORD) {
         auto original_iterator = this->tokenizer_iterator;
-        this->tokenizer_iterator += std::char_traits<char16_t>::length(Token::kw_opcode_to_cstr(memoized));
+        // The keyword was matched against every identifier character here, so it ends where they do.
+        while (token_t::is_identifier(*this->tokenizer_iterator)) {
+            ++this->tokenizer_iterator;
+        }
 
         if (memoized & OP_KW_BOOLEAN) {
-            this->base_token->token_vector.push_back(Token(
+            this->base_token->token_vector.emplace_back(
                     BOOLEAN, UNDEFINED, original_iterator, this->tokenizer_iterator,
-                    new bool(memoized == OPCODE_TRUE)));
+                    token_value_t::of_boolean(memoized == OPCODE_TRUE));
         } else {
-            this->base_token->token_vector.push_back(Token(
+            this->base_token->token_vector.emplace_back(
                     KEYWORD, UNDEFINED, original_iterator, this->tokenizer_iterator,
-                    new opcode_t(memoized)));
+                    token_value_t::of_opcode(memoized));
         }
 
         NO_INCREMENT
@@ -44,40 +51,50 @@ bool LiteralProcessor::process_keyword (const opcode_t memoized) {
 
 
 /**
- * If there's a start operator at the tokenizer_iterator when this function is called, it returns
- * an iterator to the end operator of that start operator.
- * Otherwise it throws.
- * @return
+ * If there's a start operator at the tokenizer_iterator when this function is called, it moves
+ * the tokenizer_iterator past the end operator of that start operator.
+ * Otherwise it fails with ERR_INVALID_START_OPERATOR.
+ * @return False if the range is not closed (a syntax error).
  */
-bool LiteralProcessor::parse_range (const std::optional<operator_t> memoized) {
+template <typename CharT>
+Result<bool> LiteralProcessor<CharT>::parse_range (const std::optional<operator_t> memoized) {
     auto original_iterator = this->tokenizer_iterator;
 
-    operator_t o = memoized.has_value() ? memoized.value() : this->process_symbol();
+    operator_t o;
+    if (memoized.has_value()) {
+        o = memoized.value();
+    } else if (Result<operator_t> symbol = this->process_symbol()) {
+        o = *symbol;
+    } else {
+        return failure_t {symbol.get_error()};
+    }
 
-    const char16_t* end_operator;
+    // The entry of a regex is still that of the division it was recognized as, which ends the same way.
+    const std::u16string_view end = OPERATORS[o.entry].end;
+    if (end.empty()) {
+        return failure_t {ERR_INVALID_START_OPERATOR};
+    }
 
-    try {
-        char16_t c_copy[MAX_OPERATOR_SIZE + 1];  // + 1 for \0.
-        std::char_traits<char16_t>::copy(c_copy, &(*original_iterator), o.size);
-        c_copy[o.size] = '\0';
+    const char16_t* end_operator = end.data();
+    uint8_t end_size = end.size();
 
-        end_operator = get_begin_end_map().at(c_copy);
-    } catch (const std::out_of_range& e) {
-        throw ERR_INVALID_START_OPERATOR;
+    // If this same range ran out of input last time, we pick the scan back up where it stopped.
+    int64_t nesting_level = 0;
+    if (this->suspended_range.has_value() && this->suspended_range->opcode == o.opcode) {
+        nesting_level = this->suspended_range->nesting_level;
+        this->tokenizer_iterator += this->suspended_range->offset;
     }
-
-    uint8_t end_size = std::char_traits<char16_t>::length(end_operator);
+    this->suspended_range.reset();
 
     if (o.opcode & OP_NESTABLE) {  // {, (, [
-        int64_t nesting_level = 0;
         while (nesting_level >= 0) {
             // Find next start/end operators and increment decrement nesting level until it hits -1.
-            bool begin_found, end_found, string_ended;
+            // The scan stops at the first condition that holds, so the ones after it are never assigned.
+            bool begin_found = false, end_found = false, string_ended = false;
             while (
-                    !(begin_found = std::char_traits<char16_t>::compare(
-                            &(*++this->tokenizer_iterator), &(*original_iterator), o.size) == 0) &&
-                    !(end_found = std::char_traits<char16_t>::compare(
-                            &(*this->tokenizer_iterator), end_operator, end_size) == 0) &&
+                    !(begin_found = std::char_traits<CharT>::compare(
+                            ++this->tokenizer_iterator, original_iterator, o.size) == 0) &&
+                    !(end_found = std::equal(end_operator, end_operator + end_size, this->tokenizer_iterator)) &&
                     !(string_ended = this->get_char_offset() == NOT_FOUND)
                     );
             if (begin_found) {
@@ -87,6 +104,8 @@ bool LiteralProcessor::parse_range (const std::optional<operator_t> memoized) {
                 --nesting_level;
             }
             if (string_ended) {
+                // Everything before the end has been counted already, so a resumed scan starts right at it.
+                this->suspended_range = {o.opcode, nesting_level, this->tokenizer_iterator - original_iterator - 1};
                 return false;  // Syntax error, expected closing.
             }
 
@@ -99,26 +118,48 @@ bool LiteralProcessor::parse_range (const std::optional<operator_t> memoized) {
                         o.opcode == OPCODE_BRACKET1 ? BRACKETS :
                         o.opcode == OPCODE_BRACES1 ? BRACES : NOTHING;
 
-                this->base_token->token_vector.push_back(Token(
+                this->base_token->token_vector.emplace_back(
                         type, OPCODE_TO_SUBTYPE(o.opcode),
-                        original_iterator, this->tokenizer_iterator += o.size, new opcode_t(o.opcode)));
+                        original_iterator, this->tokenizer_iterator += o.size, token_value_t::of_opcode(o.opcode));
 
                 return true;
             }
         }
 
-        // We should probably throw instead of return a syntax error?
+        // We should probably fail instead of return a syntax error?
         return false;
     } else {  // /, /*, //, `, ", '
-        // Find the next end operator.
-        was_escaped:  // If it was escaped, we retry finding the next one.
+        // Only symmetric ranges (strings, templates and regexes) have escapes.
+        const bool escapable = (o.opcode & OP_RANGE_SYM) == OP_RANGE_SYM;
+        const CharT* last_unit = this->tokenizer_iterator;  // The last code unit that was looked at on its own.
 
+        // Find the next end operator.
         while (true) {
             ++this->tokenizer_iterator;
+
+            // A backslash escapes the code unit after it, be it a quote, another backslash, or a line terminator
+            // (a line continuation, which a CR LF counts as one of).
+            if (escapable && this->get_char_offset() != NOT_FOUND && *this->tokenizer_iterator == '\\') {
+                last_unit = this->tokenizer_iterator++;
+                if (this->get_char_offset() != NOT_FOUND && *this->tokenizer_iterator == '\r' &&
+                    this->tokenizer_iterator[1] == '\n') {
+                    ++this->tokenizer_iterator;
+                }
+                if (this->get_char_offset() != NOT_FOUND) {
+                    continue;
+                }
+            }
+
             if (this->get_char_offset() == NOT_FOUND) {
+                // The last code unit might be the first half of a two unit end operator (*/) or an escape, so a
+                // resumed scan has to look at it again.
+                this->suspended_range = {
+                        o.opcode, 0, std::max<int64_t>(last_unit - original_iterator - 1, 0)};
                 return false;  // Syntax error, expected closing, but code ended before closing was found.
             }
-            if (Token::is_line_terminator(*this->tokenizer_iterator)) {
+            last_unit = this->tokenizer_iterator;
+
+            if (token_t::is_line_terminator(*this->tokenizer_iterator)) {
                 if (o.opcode == OPCODE_COMMENTL) {
                     break;
                 }
@@ -126,16 +167,11 @@ bool LiteralProcessor::parse_range (const std::optional<operator_t> memoized) {
                     return false;  // Syntax error, EOL encountered before string end.
                 }
             }
-            if (std::char_traits<char16_t>::compare(&(*this->tokenizer_iterator), end_operator, end_size) == 0) {
+            if (std::equal(end_operator, end_operator + end_size, this->tokenizer_iterator)) {
                 break;  // We found an end operator.
             }
         }
 
-        if (*(this->tokenizer_iterator - 1) == '\\' && o.opcode & OP_RANGE_SYM) {
-            // Only symmetric opcodes can be escaped with a backslash.
-            goto was_escaped;
-        }
-
         // We found the end. Create a new token.
 
         // For anything but the line-comment, we add the end operator to the tokenizer_iterator.
@@ -152,44 +188,44 @@ bool LiteralProcessor::parse_range (const std::optional<operator_t> memoized) {
 
         // Template literals, however, will have to wait for later because they can have subscopes.
         if (o.opcode == OPCODE_COMMENT1 || o.opcode == OPCODE_COMMENTL) {
-            this->base_token->token_vector.push_back(Token(
-                    COMMENT, UNDEFINED, original_iterator, this->tokenizer_iterator, nullptr));
+            this->base_token->token_vector.emplace_back(
+                    COMMENT, UNDEFINED, original_iterator, this->tokenizer_iterator, token_value_t::none());
             return true;
         }
 
         if (o.opcode == OPCODE_QDOUBLE || o.opcode == OPCODE_QSINGLE) {
-            // Keep in mind that value_ptr is not null-terminated.
-            // This means that we'll have to be careful when it ends.
-            this->base_token->token_vector.push_back(Token(
-                    STRING, UNDEFINED, original_iterator, this->tokenizer_iterator, nullptr));
+            // The value is only decoded once it is asked for (see RootToken::get_string).
+            this->base_token->token_vector.emplace_back(
+                    STRING, UNDEFINED, original_iterator, this->tokenizer_iterator, token_value_t::none());
             return true;
         }
 
         // If it's a regex, any identifiers stuck to it will be post-modifiers.
         if (o.opcode == OPCODE_REGEX) {
-            while (Token::is_identifier(*this->tokenizer_iterator)) {
+            while (token_t::is_identifier(*this->tokenizer_iterator)) {
                 this->tokenizer_iterator++;
             }
 
-            this->base_token->token_vector.push_back(Token(
-                    REGEX, UNDEFINED, original_iterator, this->tokenizer_iterator, nullptr));
+            this->base_token->token_vector.emplace_back(
+                    REGEX, UNDEFINED, original_iterator, this->tokenizer_iterator, token_value_t::none());
             return true;
         }
 
         // For now, the pre-modifiers of templates are considered separate identifiers.
         if (o.opcode == OPCODE_QTICK) {
-            this->base_token->token_vector.push_back(Token(
-                    TEMPLATE, UNDEFINED, original_iterator, this->tokenizer_iterator, nullptr));
+            this->base_token->token_vector.emplace_back(
+                    TEMPLATE, UNDEFINED, original_iterator, this->tokenizer_iterator, token_value_t::none());
             return true;
         }
 
-        // We should probably throw and not return a syntax error?
+        // We should probably fail and not return a syntax error?
         return false;
     }
 }
 
 
-bool LiteralProcessor::process_operator () {
+template <typename CharT>
+Result<bool> LiteralProcessor<CharT>::process_operator () {
     auto original_iterator = this->tokenizer_iterator;
     // We first try to process the symbol
 
@@ -199,11 +235,19 @@ bool LiteralProcessor::process_operator () {
     // process_symbol is a const function that does not move our tokenizer_iterator, but it does
     // provide us with an operator_t.size member that gives us a hint about how much we need to
     // increment our tokenizer_iterator.
-    operator_t o = this->process_symbol();
+    Result<operator_t> symbol = this->process_symbol();
+    if (!symbol) {
+        return failure_t {symbol.get_error()};
+    }
+    operator_t o = *symbol;
 
     // We have to be very careful on OPCODE_DIV which can be the regex starter.
     // We call LiteralProcessor->next_token_is_regex to find out.
-    if (this->next_token_is_regex(o)) {
+    Result<bool> regex = this->next_token_is_regex(o);
+    if (!regex) {
+        return failure_t {regex.get_error()};
+    }
+    if (*regex) {
         o.opcode = OPCODE_REGEX;
     }
 
@@ -216,38 +260,59 @@ bool LiteralProcessor::process_operator () {
         // If it's a start operator, we need to find its end.
         return this->parse_range(o);
     } else {
-        this->base_token->token_vector.push_back(Token(
+        this->base_token->token_vector.emplace_back(
                 OPERATOR, OPCODE_TO_SUBTYPE(o.opcode),
-                original_iterator, this->tokenizer_iterator += o.size, new opcode_t(o.opcode)));
+                original_iterator, this->tokenizer_iterator += o.size, token_value_t::of_opcode(o.opcode));
         return true;
     }
 }
 
-bool LiteralProcessor::next_token_is_regex (const std::optional<operator_t> memoized) {
-    operator_t o = memoized.has_value() ? memoized.value() : this->process_symbol();
+template <typename CharT>
+Result<bool> LiteralProcessor<CharT>::next_token_is_regex (const std::optional<operator_t> memoized) {
+    operator_t o;
+    if (memoized.has_value()) {
+        o = memoized.value();
+    } else if (Result<operator_t> symbol = this->process_symbol()) {
+        o = *symbol;
+    } else {
+        return failure_t {symbol.get_error()};
+    }
 
     if (o.opcode != OPCODE_DIV) {  // If it doesn't start with the division symbol, it can't be regex.
         return false;
     }
 
-    // We look at the last token in our token vector:
-    auto last_token = this->base_token->token_vector.end();  // std::vector<Token>::iterator
+    // We look at the last token in our token vector. Skipping comments and whitespace only needs the type column.
+    auto& tokens = this->base_token->token_vector;
+    size_t last_token = tokens.size();
 
-    while ((*--last_token).is_discardable());  // Comments and whitespace should not affect our lookbehind.
+    // If we run out of tokens to look at, we are at the start of the input, where only a regex can appear.
+    do {
+        if (last_token == 0) return this->lookbehind_exhausted = true;
+    } while (token_t::is_discardable(tokens.get_type(--last_token)));  // They should not affect our lookbehind.
 
-    while (true) {
-        try {
-            if ((*last_token).cannot_precede_division()) return true;
-        } catch (error_t e) {
-            last_token--;
-            continue;
-        }
-
-        break;
+    // Tokens that are ambiguous leave it to the token before them.
+    std::optional<bool> cannot_precede_division;
+    while (!(cannot_precede_division = tokens[last_token].cannot_precede_division()).has_value()) {
+        if (last_token == 0) return this->lookbehind_exhausted = true;
+        last_token--;
     }
 
-    // The token before could precede division, so we'll assume this is division and not regex.
-    return false;
+    // If the token before could precede division, we'll assume this is division and not regex.
+    return *cannot_precede_division;
+}
+
+/**
+ * Interns an identifier into the identifier table of the base token, unless identifiers are not interned.
+ * @param identifier
+ * @return The value of an identifier token, which is the id of the identifier, or no value.
+ */
+template <typename CharT>
+token_value_t LiteralProcessor<CharT>::resolve_identifier (const std::basic_string_view<CharT> identifier) {
+    if (!this->intern_identifiers) {
+        return token_value_t::none();
+    }
+    return token_value_t::of_identifier(this->base_token->identifiers.intern(identifier));
 }
 
 /**
@@ -256,51 +321,21 @@ bool LiteralProcessor::next_token_is_regex (const std::optional<operator_t> memo
  * allowing us to continue processing.
  * @return
  */
-bool LiteralProcessor::process_identifier () {
+template <typename CharT>
+bool LiteralProcessor<CharT>::process_identifier () {
     auto original_iterator = this->tokenizer_iterator;
 
     // An identifier consists only of identifier characters and digit characters.
-    for (; this->get_char_offset() != NOT_FOUND; ++this->tokenizer_iterator) {
-        if (!Token::is_identifier(*this->tokenizer_iterator) && !Token::is_digit(*this->tokenizer_iterator)) {
-            break;
-        }
-    }
-
-    std::u16string identifier(original_iterator, this->tokenizer_iterator);
-
-    // This is the base_token of this LiteralProcessor. In the loop below, it will keep bubbling up
-    // through parents.
-    auto curent_token = this->base_token;
-    std::vector<std::u16string>::iterator position;
-    while (true) {
-        position = std::find(
-                curent_token->identifier_stack.begin(), curent_token->identifier_stack.end(), identifier);
-        if (position == curent_token->identifier_stack.end()) {
-            // If we don't find the identifier:
-            if (curent_token->parent != nullptr) {
-                // If a parent exists, we bubble up.
-                curent_token = curent_token->parent;
-            } else {
-                // If we bubbled up all the way to the end and didn't find that specific identifier,
-                // we just push to the bottom-most scope (the base token).
-                this->base_token->identifier_stack.push_back(identifier);
-                break;
-            }
-        } else {
-            // If we find the identifier somewhere, we just break since position is now at the value we want it.
-            break;
-        }
-
+    this->tokenizer_iterator = skip_identifier_part(this->tokenizer_iterator, this->get_input_end());
 
-    }
-
-    // Create a token with the identifier index in the identifier stack.
-    this->base_token->token_vector.push_back(Token(
+    // Create a token with the id of the identifier in the identifier table.
+    this->base_token->token_vector.emplace_back(
             IDENTIFIER, UNDEFINED, original_iterator, this->tokenizer_iterator,
-            (void*)(&*position)));
+            this->resolve_identifier(std::basic_string_view<CharT>(
+                    original_iterator, this->tokenizer_iterator - original_iterator)));
 
-    // We don't need to increment in this function because no matter what way the for ends (the break or normal end),
-    // we have reached something that isn't part of this identifier.
+    // We don't need to increment in this function because the scan stops at the end of the input or at something
+    // that isn't part of this identifier.
     NO_INCREMENT
 
     return true;  // Anything can show up suddenly mid-identifier, so identifiers never return false.
@@ -312,7 +347,8 @@ bool LiteralProcessor::process_identifier () {
  * allowing us to continue processing.
  * @return
  */
-bool LiteralProcessor::process_number_literal () {
+template <typename CharT>
+bool LiteralProcessor<CharT>::process_number_literal () {
     auto original_iterator = this->tokenizer_iterator;
 
     token_subtype_t subtype = UNDEFINED;
@@ -357,7 +393,7 @@ bool LiteralProcessor::process_number_literal () {
         }
 
         // If we know it's not a decimal and we find a digit, we know it's octal.
-        if (Token::is_digit(*this->tokenizer_iterator) && subtype == INT_SPEC) {
+        if (token_t::is_digit(*this->tokenizer_iterator) && subtype == INT_SPEC) {
             subtype = INT_OCT;  // We do not continue here, as this is an actual digit of the number.
         }
 
@@ -371,7 +407,7 @@ bool LiteralProcessor::process_number_literal () {
         }
 
         // We accumulate each digit to the value of the token.
-        if (Token::is_digit(*this->tokenizer_iterator)) {
+        if (token_t::is_digit(*this->tokenizer_iterator)) {
             accumulator *= subtype;
             decimal_accumulator *= INT_DEC;
             uint8_t temp = *this->tokenizer_iterator - '0';
@@ -395,7 +431,7 @@ bool LiteralProcessor::process_number_literal () {
         }
 
         // If we find a hexadecimal digit in a hexadecimal number, we convert and accumulate.
-        if (Token::is_hexadecimal_digit(*this->tokenizer_iterator) && subtype == INT_HEX) {
+        if (token_t::is_hexadecimal_digit(*this->tokenizer_iterator) && subtype == INT_HEX) {
             accumulator *= subtype;
             uint8_t temp = *this->tokenizer_iterator - 'a' + 10;
             accumulator += temp;
@@ -428,7 +464,7 @@ bool LiteralProcessor::process_number_literal () {
         }
 
         // If we find a non-identifier, non-dot, we have reached the end of the number and we break.
-        if (!Token::is_identifier(*this->tokenizer_iterator) && *this->tokenizer_iterator != '.') {
+        if (!token_t::is_identifier(*this->tokenizer_iterator) && *this->tokenizer_iterator != '.') {
             // We do not increment here, as this thing we just found isn't part of the number,
             // but rather a part of the next token.
             NO_INCREMENT
@@ -446,15 +482,18 @@ bool LiteralProcessor::process_number_literal () {
         while (temp > 1) temp /= 10;
         accumulator_f += temp;
         accumulator_f *= sign;
-        this->base_token->token_vector.push_back(Token(
+        this->base_token->token_vector.emplace_back(
                 NUMBER, subtype, original_iterator, this->tokenizer_iterator,
-                new double(accumulator_f)));
+                token_value_t::of_double(accumulator_f));
     } else {
         accumulator *= sign;
-        this->base_token->token_vector.push_back(Token(
+        this->base_token->token_vector.emplace_back(
                 NUMBER, subtype, original_iterator, this->tokenizer_iterator,
-                new int64_t(accumulator)));
+                token_value_t::of_integer(accumulator));
     }
 
     return true;
 }
+
+template class LiteralProcessor<char16_t>;
+template class LiteralProcessor<char>;
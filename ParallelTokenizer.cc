@@ -0,0 +1,231 @@
+#include <ParallelTokenizer.h>
+#include <TokenCache.h>
+#include <thread>
+
+template <typename CharT>
+BasicParallelTokenizer<CharT>::BasicParallelTokenizer (int log_handler (const char*, ...), const size_t jobs)
+        : BasicTokenizer<CharT>(log_handler),
+          jobs(jobs ? jobs : std::max(1u, std::thread::hardware_concurrency())) {}
+
+/**
+ * Maps a file (or reads it, if it cannot be mapped) and then attempts to tokenize it on several threads.
+ * If there is a cache, and it has the tokens of the file, the file is not lexed at all.
+ * The root holds on to the contents of the file, so it stays valid after the next file is tokenized.
+ * @param file_name
+ * @return The root, or the error that the file failed to load or to tokenize with.
+ */
+template <typename CharT>
+Result<typename BasicParallelTokenizer<CharT>::root_t>
+BasicParallelTokenizer<CharT>::tokenize (const char* file_name) {
+    std::shared_ptr<const void> owner;
+    Result<std::basic_string_view<CharT>> content = this->load(file_name, owner);
+    if (!content) {
+        return failure_t {content.get_error()};
+    }
+
+    if (this->cache == nullptr) {
+        Result<root_t> rv = this->tokenize(*content);
+        if (rv) {
+            rv->source = std::move(owner);
+        }
+        return rv;
+    }
+
+    if (auto cached = this->cache->find(*content)) {
+        cached->source = std::move(owner);
+        return std::move(*cached);
+    }
+
+    Result<root_t> rv = this->tokenize(*content);
+    if (rv) {
+        this->cache->store(*content, *rv);
+        rv->source = std::move(owner);
+    }
+    return rv;
+}
+
+template <typename CharT>
+Result<typename BasicParallelTokenizer<CharT>::root_t>
+BasicParallelTokenizer<CharT>::tokenize (std::basic_string_view<CharT> str) {
+    return this->tokenize(str.data(), str.data() + str.size());
+}
+
+/**
+ * Attempts to tokenize a given two iterators on several threads. Inputs too small to be worth splitting are
+ * tokenized serially. Like for BasicTokenizer::tokenize, the code unit at end must be readable and should be a '\0'.
+ * @param begin
+ * @param end
+ * @return The root, or ERR_INPUT_TOO_LARGE, ERR_TOKENIZING_SYNTAX_ERROR, or any other error the lexer failed with.
+ */
+template <typename CharT>
+Result<typename BasicParallelTokenizer<CharT>::root_t>
+BasicParallelTokenizer<CharT>::tokenize (const CharT* const begin, const CharT* const end) {
+    const size_t n = end - begin;
+    if (n > MAX_INPUT_SIZE) {
+        return failure_t {ERR_INPUT_TOO_LARGE};
+    }
+
+    const size_t chunk_count = std::min(this->jobs, n / PARALLEL_MIN_CHUNK_SIZE);
+
+    if (chunk_count < 2) {
+        return BasicTokenizer<CharT>::tokenize(begin, end);
+    }
+
+    // Each split is looked for between its even share of the input and the next one, so splits always increase.
+    // A share without a good split point is merged into the chunk before it.
+    std::vector<const CharT*> splits {begin};
+    for (size_t i = 1; i < chunk_count; ++i) {
+        auto limit = begin + n * (i + 1) / chunk_count;
+        auto split = this->find_split(begin + n * i / chunk_count, limit);
+        if (split != limit) {
+            splits.push_back(split);
+        }
+    }
+    splits.push_back(end);
+
+    std::vector<speculation_t> speculations(splits.size() - 1);
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < speculations.size(); ++i) {
+        threads.emplace_back([&, i] () {
+            BasicParallelTokenizer<CharT> worker(this->log_handler, 1);
+            worker.speculate(splits[i], splits[i + 1], end, speculations[i]);
+        });
+    }
+
+    // The first chunk starts where the input starts, so there is nothing to guess, and it is lexed for real
+    // while the other chunks are being guessed.
+    this->tokenizer_iterator = begin;
+    this->suspended_range.reset();
+    this->expecting_iterator = 0;
+    this->expect(ANYTHING);
+
+    auto rv = root_t(ROOT, UNDEFINED, begin, end, token_value_t::none(), this->reuse_arena());
+    rv.token_vector.reserve_for(end);
+
+    this->base_token = &rv;
+
+    Result<bool> valid = this->lex_until(splits[1]);
+
+    for (auto& thread: threads) {
+        thread.join();
+    }
+
+    for (size_t i = 1; valid && *valid && i < speculations.size(); ++i) {
+        auto& speculation = speculations[i];
+
+        if (this->tokenizer_iterator == splits[i] && speculation.valid && !speculation.exhausted &&
+            this->expecting_iterator == 1 && this->expecting[0] == ANYTHING) {
+            this->adopt(speculation);
+        } else {
+            valid = this->lex_until(splits[i + 1]);
+        }
+
+        speculation.root.reset();
+    }
+
+    bool complete = this->get_char_offset() == NOT_FOUND;
+    this->base_token = nullptr;
+
+    if (!valid) {
+        return failure_t {valid.get_error()};
+    }
+    if (!*valid || !complete) {
+        return failure_t {ERR_TOKENIZING_SYNTAX_ERROR};
+    }
+
+    return rv;
+}
+
+/**
+ * Looks for a line that starts right away with an identifier or keyword, which is most likely a top level
+ * statement, and so a token boundary in plain code.
+ * @param target Where to start looking.
+ * @param limit Where to stop looking.
+ * @return The start of that line, or limit if there is none.
+ */
+template <typename CharT>
+const CharT* BasicParallelTokenizer<CharT>::find_split (const CharT* target, const CharT* const limit) {
+    for (; target + 1 < limit; ++target) {
+        if (*target == '\n' && token_t::is_identifier(target[1])) {
+            return target + 1;
+        }
+    }
+
+    return limit;
+}
+
+/**
+ * Lexes a chunk on the guess that it starts at a token boundary in plain code.
+ * Lexing goes on past the end of the chunk until the last token ends, and can look at the whole input after it.
+ * @param begin The start of the chunk.
+ * @param stop The end of the chunk.
+ * @param end The end of the whole input.
+ * @param speculation Where to leave the tokens and the state the lexer ended in.
+ */
+template <typename CharT>
+void BasicParallelTokenizer<CharT>::speculate (const CharT* const begin, const CharT* const stop,
+                                               const CharT* const end, speculation_t& speculation) {
+    speculation.root.emplace(ROOT, UNDEFINED, begin, end, token_value_t::none());
+    speculation.root->token_vector.reserve_for(stop);
+
+    this->base_token = &*speculation.root;
+    this->tokenizer_iterator = begin;
+    this->lookbehind_exhausted = false;
+
+    // A wrong guess can run into anything, and is simply lexed again while stitching.
+    Result<bool> valid = this->lex_until(stop);
+    speculation.valid = valid && *valid;
+
+    speculation.stop = this->tokenizer_iterator;
+    std::copy_n(this->expecting, EXPECTING_BUFFER_N, speculation.expecting);
+    speculation.expecting_iterator = this->expecting_iterator;
+    speculation.exhausted = this->lookbehind_exhausted;
+
+    this->base_token = nullptr;
+}
+
+/**
+ * Appends the tokens of a chunk whose guess was right, and carries on from where its lexer stopped.
+ * The identifiers of the chunk are resolved again, so that they are ids in the identifier table of the base token.
+ * @param speculation
+ */
+template <typename CharT>
+void BasicParallelTokenizer<CharT>::adopt (speculation_t& speculation) {
+    for (auto token: speculation.root->token_vector) {
+        if (token.get_type() == IDENTIFIER) {
+            auto text = token.get_text();
+            this->base_token->token_vector.emplace_back(
+                    IDENTIFIER, token.get_subtype(), text.data(), text.data() + text.size(),
+                    this->resolve_identifier(text));
+        } else {
+            this->base_token->token_vector.push_back(token);
+        }
+    }
+
+    this->tokenizer_iterator = speculation.stop;
+    std::copy_n(speculation.expecting, EXPECTING_BUFFER_N, this->expecting);
+    this->expecting_iterator = speculation.expecting_iterator;
+}
+
+/**
+ * Processes tokens until one ends at or past stop, or the input ends.
+ * @param stop
+ * @return False if a syntax error was encountered, or the error that the lexer failed with.
+ */
+template <typename CharT>
+Result<bool> BasicParallelTokenizer<CharT>::lex_until (const CharT* const stop) {
+    while (this->tokenizer_iterator < stop) {
+        Result<bool> processed = this->process_next_token();
+        if (!processed) {
+            return processed;
+        }
+        if (!*processed) {
+            return this->get_char_offset() == NOT_FOUND;
+        }
+    }
+
+    return true;
+}
+
+template class BasicParallelTokenizer<char16_t>;
+template class BasicParallelTokenizer<char>;
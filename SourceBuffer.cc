@@ -0,0 +1,180 @@
+#include <SourceBuffer.h>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define READ_CHUNK_SIZE 0x01'00'00
+
+SourceBuffer::SourceBuffer (SourceBuffer&& other) noexcept {
+    *this = std::move(other);
+}
+
+SourceBuffer& SourceBuffer::operator= (SourceBuffer&& other) noexcept {
+    if (this != &other) {
+        this->release();
+
+        this->buffer = std::move(other.buffer);
+        this->data = other.mapping_size ? other.data : this->buffer.data();
+        this->data_size = other.data_size;
+        this->mapping_size = other.mapping_size;
+
+        other.data = nullptr;
+        other.data_size = 0;
+        other.mapping_size = 0;
+    }
+
+    return *this;
+}
+
+SourceBuffer::~SourceBuffer () {
+    this->release();
+}
+
+/**
+ * Opens a file and loads it, either by mapping it or by reading it.
+ * @param file_name
+ * @return SUCCESS, or ERR_IFSTREAM_FAILED if the file cannot be opened or read.
+ */
+err_t SourceBuffer::load (const char* file_name) {
+    int fd = open(file_name, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0) {
+        return ERR_IFSTREAM_FAILED;
+    }
+
+    // Closed on the way out, even if reading the file runs out of memory.
+    // The mapping stays valid after the descriptor is closed.
+    struct descriptor_closer_t {
+        int fd;
+        ~descriptor_closer_t () { close(this->fd); }
+    } closer {fd};
+
+    return this->load(fd);
+}
+
+/**
+ * Loads an already open file descriptor. The descriptor is not closed.
+ * Regular files get mapped, anything else is read until EOF.
+ * @param fd
+ * @return SUCCESS, or ERR_IFSTREAM_FAILED if the descriptor cannot be read.
+ */
+err_t SourceBuffer::load (const int fd) {
+    this->release();
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0) {
+        return ERR_IFSTREAM_FAILED;
+    }
+
+    if (S_ISREG(st.st_mode) && st.st_size > 0 && this->map(fd, st.st_size)) {
+        return SUCCESS;
+    }
+
+    return this->read_all(fd);
+}
+
+/**
+ * Unmaps or frees whatever is currently loaded.
+ */
+void SourceBuffer::release () {
+    if (this->mapping_size) {
+        munmap(const_cast<char*>(this->data), this->mapping_size);
+    }
+
+    this->buffer.clear();
+    this->buffer.shrink_to_fit();
+    this->data = nullptr;
+    this->data_size = 0;
+    this->mapping_size = 0;
+}
+
+/**
+ * Maps the file read-only. We first reserve an anonymous zero-filled region one byte larger than the
+ * file (rounded up to the page size), then map the file over its start. This way the byte after the
+ * end of the file is always a '\0', even when the file size is an exact multiple of the page size.
+ * @param fd
+ * @param file_size
+ * @return Whether the mapping succeeded. If not, the caller should fall back to reading.
+ */
+bool SourceBuffer::map (const int fd, const size_t file_size) {
+    auto page_size = (size_t) sysconf(_SC_PAGESIZE);
+    size_t region_size = (file_size + 1 + page_size - 1) / page_size * page_size;
+
+    void* region = mmap(nullptr, region_size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED) {
+        return false;
+    }
+
+    if (mmap(region, file_size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(region, region_size);
+        return false;
+    }
+
+    // The tokenizer walks the file front to back exactly once, so let the kernel read ahead aggressively
+    // and drop pages behind us.
+    madvise(region, file_size, MADV_SEQUENTIAL);
+
+    this->data = (const char*) region;
+    this->data_size = file_size;
+    this->mapping_size = region_size;
+
+    return true;
+}
+
+/**
+ * Reads everything from the descriptor until EOF. Used for pipes and other unmappable inputs.
+ * @param fd
+ * @return SUCCESS, or ERR_IFSTREAM_FAILED, in which case nothing is loaded.
+ */
+err_t SourceBuffer::read_all (const int fd) {
+    size_t used = 0;
+
+    while (true) {
+        if (this->buffer.size() - used < READ_CHUNK_SIZE) {
+            this->buffer.resize(used + READ_CHUNK_SIZE);
+        }
+
+        ssize_t n = read(fd, this->buffer.data() + used, this->buffer.size() - used);
+
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            this->release();
+            return ERR_IFSTREAM_FAILED;
+        }
+
+        if (n == 0) {
+            break;
+        }
+
+        used += n;
+    }
+
+    this->buffer.resize(used + 1);
+    this->buffer[used] = '\0';
+
+    this->data = this->buffer.data();
+    this->data_size = used;
+
+    return SUCCESS;
+}
+
+const char* SourceBuffer::begin () const {
+    return this->data;
+}
+
+const char* SourceBuffer::end () const {
+    return this->data + this->data_size;
+}
+
+size_t SourceBuffer::size () const {
+    return this->data_size;
+}
+
+bool SourceBuffer::is_mapped () const {
+    return this->mapping_size != 0;
+}
@@ -0,0 +1,265 @@
+#include <StreamTokenizer.h>
+
+template <typename CharT>
+BasicStreamTokenizer<CharT>::BasicStreamTokenizer (int log_handler (const char*, ...), token_handler_t token_handler)
+        : BasicTokenizer<CharT>(log_handler), token_handler(std::move(token_handler)) {
+    this->intern_identifiers = false;
+}
+
+/**
+ * Appends a chunk of input, and hands every token that is now known to be complete to the token handler.
+ * @param data
+ * @param size
+ * @return SUCCESS, or the error that the input ran into, after which the stream tokenizer needs to be reset.
+ */
+template <typename CharT>
+err_t BasicStreamTokenizer<CharT>::feed (const CharT* const data, const size_t size) {
+    this->pending.append(data, size);
+    return this->process_pending(false);
+}
+
+template <typename CharT>
+err_t BasicStreamTokenizer<CharT>::feed (std::basic_string_view<CharT> str) {
+    return this->feed(str.data(), str.size());
+}
+
+/**
+ * Appends a chunk of UTF-8 input, transcoding it first if the lexer works on UTF-16. A multi-byte sequence that
+ * the chunk cuts off is kept until the next chunk completes it.
+ * @param data
+ * @param size
+ * @return SUCCESS, or the error that the input ran into, like for feed.
+ */
+template <typename CharT>
+err_t BasicStreamTokenizer<CharT>::feed_utf8 (const char* const data, const size_t size) {
+    if constexpr (std::is_same_v<CharT, char>) {
+        return this->feed(data, size);
+    } else {
+        this->undecoded.append(data, size);
+
+        std::u16string decoded;
+        int64_t invalid_offset = utf8_to_utf16(
+                this->undecoded.data(), this->undecoded.data() + this->undecoded.size(), decoded);
+
+        // No sequence is longer than 4 bytes, so only the last 3 can still be completed by the next chunk.
+        auto decoded_size = invalid_offset == NOT_FOUND ? this->undecoded.size() : (size_t) invalid_offset;
+        if (this->undecoded.size() - decoded_size > 3) {
+            return ERR_INVALID_UTF8;
+        }
+
+        this->undecoded.erase(0, decoded_size);
+        return this->feed(decoded);
+    }
+}
+
+/**
+ * Signals the end of the input. Whatever is still pending gets tokenized for good, and if it does not make up
+ * complete tokens, it is a syntax error like it would be for BasicTokenizer::tokenize.
+ * The stream tokenizer is ready for a new input afterwards, unless this fails, in which case it needs to be reset.
+ * @return SUCCESS, or the error that the input ran into.
+ */
+template <typename CharT>
+err_t BasicStreamTokenizer<CharT>::finish () {
+    if (!this->undecoded.empty()) {
+        return ERR_INVALID_UTF8;
+    }
+
+    if (err_t error = this->process_pending(true)) {
+        return error;
+    }
+
+    this->reset();
+    return SUCCESS;
+}
+
+/**
+ * Drops everything from the current input. Needs to be called before reusing the stream tokenizer after an error.
+ */
+template <typename CharT>
+void BasicStreamTokenizer<CharT>::reset () {
+    this->pending.clear();
+    this->history.clear();
+    this->undecoded.clear();
+    this->suspended_range.reset();
+
+    this->expecting_iterator = 0;
+    this->expect(ANYTHING);
+}
+
+/**
+ * Tokenizes as much of this->pending as possible.
+ *
+ * Unless this is the final chunk, a token that the lexer finished (or gave up on) within LEXER_LOOKAHEAD code
+ * units of the end of the buffer is rolled back, because more input could still change it (see is_settled). The
+ * buffer is then cut down to start at that token, which is tokenized again once more input arrives. If that token
+ * is a range that ran out of input, parse_range left this->suspended_range behind, so its scan resumes instead of
+ * starting over.
+ * @param final
+ * @return SUCCESS, or ERR_TOKENIZING_SYNTAX_ERROR, or any other error that the lexer failed with.
+ */
+template <typename CharT>
+err_t BasicStreamTokenizer<CharT>::process_pending (const bool final) {
+    if (this->pending.size() > MAX_INPUT_SIZE) {
+        return ERR_INPUT_TOO_LARGE;
+    }
+
+    const CharT* begin = this->pending.data();
+    const CharT* end = begin + this->pending.size();
+
+    // The root only lives for this call, since it spans this buffer. What has to outlive it gets moved in and out.
+    auto root = root_t(ROOT, UNDEFINED, begin, end, token_value_t::none());
+    root.token_vector = std::move(this->history);
+    root.token_vector.set_base(begin);
+
+    this->base_token = &root;
+    this->tokenizer_iterator = begin;
+
+    const CharT* last_terminator = end;
+    while (last_terminator != begin && *(last_terminator - 1) != '\n' && *(last_terminator - 1) != ';') {
+        --last_terminator;
+    }
+    last_terminator = last_terminator != begin ? last_terminator - 1 : nullptr;
+
+    err_t error = SUCCESS;
+    bool syntax_error = false;
+
+    while (this->get_char_offset() != NOT_FOUND) {
+        auto token_begin = this->tokenizer_iterator;
+        auto token_count = root.token_vector.size();
+        token_type_t expecting_copy[EXPECTING_BUFFER_N];
+        std::copy_n(this->expecting, EXPECTING_BUFFER_N, expecting_copy);
+        auto expecting_iterator_copy = this->expecting_iterator;
+
+        Result<bool> processed = this->process_next_token();
+        if (!processed) {
+            error = processed.get_error();
+            break;
+        }
+
+        if (!final && end - this->tokenizer_iterator < LEXER_LOOKAHEAD &&
+            !(*processed && this->is_settled(root, token_count, last_terminator))) {
+            while (root.token_vector.size() > token_count) {
+                root.token_vector.pop_back();
+            }
+            this->tokenizer_iterator = token_begin;
+            std::copy_n(expecting_copy, EXPECTING_BUFFER_N, this->expecting);
+            this->expecting_iterator = expecting_iterator_copy;
+            break;
+        }
+
+        if (!*processed) {
+            syntax_error = true;
+            break;
+        }
+
+        for (auto i = token_count; i < root.token_vector.size(); ++i) {
+            auto token = root.token_vector[i];
+            this->token_handler(token);
+        }
+    }
+
+    bool complete = this->get_char_offset() == NOT_FOUND;
+    auto consumed = this->tokenizer_iterator - begin;
+
+    this->history = std::move(root.token_vector);
+    this->base_token = nullptr;
+
+    if (error != SUCCESS) {
+        return error;
+    }
+    if (syntax_error || (final && !complete)) {
+        return ERR_TOKENIZING_SYNTAX_ERROR;
+    }
+
+    this->trim_history();
+    this->pending.erase(0, consumed);
+    return SUCCESS;
+}
+
+/**
+ * Whether the tokens that were just processed are final even though they end close to the end of the buffer.
+ *
+ * Keywords, operators, numbers and whitespace all stop at a line feed or a ';', and a range ends at its own closing
+ * code units, so no token reaches past one of them without having ended already. Tokens that end at or before the
+ * last of them, and the line feed or ';' token itself, cannot change with more input.
+ * @param root
+ * @param token_count How many tokens the root had before they were processed.
+ * @param last_terminator The last line feed or ';' in the buffer, or nullptr if there is none.
+ * @return
+ */
+template <typename CharT>
+bool BasicStreamTokenizer<CharT>::is_settled (root_t& root, const size_t token_count,
+                                              const CharT* const last_terminator) {
+    if (last_terminator == nullptr) {
+        return false;
+    }
+
+    if (this->tokenizer_iterator <= last_terminator) {
+        return true;
+    }
+
+    auto type = root.token_vector.back().get_type();
+    return this->tokenizer_iterator == last_terminator + 1 && root.token_vector.size() == token_count + 1 &&
+           (type == EOL || type == EOS);
+}
+
+/**
+ * Drops the tokens that next_token_is_regex can never look at again.
+ *
+ * The lookbehind skips back over discardable tokens, then over ambiguous ones (see Token::cannot_precede_division),
+ * and stops at the first token that is neither. Once the tokens after the history have all been skipped over, it
+ * comes to the history either still skipping discardable tokens, and so stops at the last token that is not
+ * discardable (or at the last unambiguous token before it, if that one is ambiguous), or only skipping ambiguous
+ * ones, and so stops at the last unambiguous token. Only those (at most three) tokens are kept, in their order. With
+ * none of them, the lookbehind runs out of tokens, which it does on an empty history too.
+ *
+ * The kept tokens still point into input that is about to be dropped, so only their type and value may be used.
+ * They are gathered in this->kept, which is then swapped with the history, so that neither list has to be allocated
+ * again once both have grown to what a chunk takes.
+ */
+template <typename CharT>
+void BasicStreamTokenizer<CharT>::trim_history () {
+    auto& history = this->history;
+    if (history.size() <= 3) {
+        return;
+    }
+
+    // The last unambiguous token before end.
+    auto last_unambiguous = [&] (size_t end) -> std::optional<size_t> {
+        while (end > 0) {
+            if (history[--end].cannot_precede_division().has_value()) {
+                return end;
+            }
+        }
+        return std::nullopt;
+    };
+
+    size_t end = history.size();
+    while (end > 0 && history[end - 1].is_discardable()) {
+        --end;
+    }
+
+    std::optional<size_t> kept_indices[3] = {std::nullopt, std::nullopt, last_unambiguous(history.size())};
+    if (end > 0) {
+        kept_indices[1] = end - 1;
+        if (!history[end - 1].cannot_precede_division().has_value()) {
+            kept_indices[0] = last_unambiguous(end - 1);
+        }
+    }
+    std::sort(std::begin(kept_indices), std::end(kept_indices));
+
+    auto& kept = this->kept;
+    kept.clear();
+    kept.set_base(history.get_base());
+    std::optional<size_t> previous;
+    for (const auto& i: kept_indices) {
+        if (i.has_value() && i != previous) {
+            kept.push_back(history[*i]);
+            previous = i;
+        }
+    }
+    std::swap(history, kept);
+}
+
+template class BasicStreamTokenizer<char16_t>;
+template class BasicStreamTokenizer<char>;
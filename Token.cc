@@ -1,79 +1,208 @@
 #include <Token.h>
 #include <colors.h>  // Specified here because everything else that includes tokens should not need colors.
 
-bool Token::is_digit (const char16_t c) {
-    return c >= '0' && c <= '9';
-}
-
-bool Token::is_hexadecimal_digit (const char16_t c) {
-    return (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
-}
+/**
+ * Looks up the keyword that the identifier characters at c spell, through the perfect hash of KEYWORD_SLOTS.
+ * A name that is not a keyword is turned away by its size, or by its slot being empty, or at worst by comparing it
+ * to the one keyword in its slot.
+ * @param c
+ * @return The opcode of the keyword, or OPCODE_NOOP if there is none.
+ */
+template <typename CharT>
+opcode_t BasicToken<CharT>::kw_cstr_to_opcode (const CharT* const c) {
+    uint8_t size = 0;
+    for (; size < OP_KEYWORD_SIZE && BasicToken::is_identifier(c[size]); ++size);  // Keywords are only those.
+
+    if (size < KEYWORD_MIN_SIZE || size >= OP_KEYWORD_SIZE) {
+        return OPCODE_NOOP;
+    }
 
-bool Token::is_identifier (const char16_t c) {
-    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '$';
-}
+    const uint8_t slot = KEYWORD_SLOTS[keyword_hash(c[0], c[1], c[size - 1], size)];
+    if (slot == KEYWORD_NO_SLOT) {
+        return OPCODE_NOOP;
+    }
 
-bool Token::is_whitespace (const char16_t c) {
-    for (int i = 0; i < sizeof(WHITESPACE_CHARACTERS) / sizeof(char) - 1; ++i) {
-        if (c == WHITESPACE_CHARACTERS[i]) {
-            return true;
-        }
+    // Keywords are plain ASCII, so the code units of either encoding compare the same.
+    const keyword_t& keyword = KEYWORDS[slot];
+    if (keyword.text.size() != size || !std::equal(c, c + size, keyword.text.begin())) {
+        return OPCODE_NOOP;
     }
-    return false;
-}
 
-bool Token::is_line_terminator (const char16_t c) {
-    return c == '\r' || c == '\n';
+    return keyword.opcode;
 }
 
-opcode_t Token::kw_cstr_to_opcode (const char16_t* const c) {
-    uint8_t end = 0;
-    char16_t c_copy[OP_KEYWORD_SIZE];
-
-    for (; end < OP_KEYWORD_SIZE; ++end) {
-        if (!Token::is_identifier(c[end])) {  // Keywords can only include identifier characters.
-            break;
+/**
+ * @param keyword_opcode
+ * @return The keyword with that opcode, or nullptr if there is none.
+ */
+template <typename CharT>
+const char16_t* BasicToken<CharT>::kw_opcode_to_cstr (const opcode_t keyword_opcode) {
+    for (const auto& keyword: KEYWORDS) {
+        if (keyword.opcode == keyword_opcode) {
+            return keyword.text.data();
         }
     }
 
-    std::char_traits<char16_t>::copy(c_copy, c, end);
-    c_copy[end] = '\0';
-
-    try {
-        return get_kw_cstr_opcode_map().at(c_copy);
-    } catch (const std::out_of_range& e) {
-        return OPCODE_NOOP;
-    }
+    return nullptr;
 }
 
-const char16_t* Token::kw_opcode_to_cstr (const opcode_t keyword_opcode) {
-    return get_kw_opcode_cstr_map().at(keyword_opcode);
-}
+/**
+ * Decodes the escape sequences in the body of a string literal (what is between its quotes) into its value.
+ *
+ * Handles single character escapes, \xHH, \uHHHH, \u{H...}, legacy octal escapes, and line continuations (a
+ * backslash before a line terminator, which is left out of the value). Any other escaped code unit stands for
+ * itself. A UTF-8 value gets an escaped surrogate pair as the single code point it encodes.
+ * @param body
+ * @param result Cleared, then set to the value.
+ * @return SUCCESS, or ERR_INVALID_ESCAPE, in which case result holds whatever was decoded before the escape.
+ */
+template <typename CharT>
+err_t BasicToken<CharT>::decode_string (const std::basic_string_view<CharT> body, std::basic_string<CharT>& result) {
+    result.clear();
+
+    size_t i = 0;
+
+    // Reads count hex digits at i (or up to the '}' if count is 0) into a code point, and moves i past them.
+    auto read_hex = [&] (const size_t count) -> std::optional<char32_t> {
+        char32_t code_point = 0;
+        size_t digits = 0;
+        for (; i < body.size() && (count == 0 ? body[i] != '}' : digits < count); ++i, ++digits) {
+            char16_t c = body[i];
+            if (!BasicToken::is_in_class(c, CHAR_DIGIT | CHAR_HEXADECIMAL)) {
+                return std::nullopt;
+            }
+            code_point = code_point * 16 + (BasicToken::is_digit(c) ? c - '0' : (c | 0x20u) - 'a' + 10);
+            if (code_point > 0x10'ff'ff) {
+                return std::nullopt;
+            }
+        }
+        if (digits == 0 || (count != 0 && digits != count)) {
+            return std::nullopt;
+        }
+        return code_point;
+    };
+
+    while (i < body.size()) {
+        CharT c = body[i++];
+        if (c != '\\') {
+            result.push_back(c);
+            continue;
+        }
+
+        if (i == body.size()) {
+            return ERR_INVALID_ESCAPE;
+        }
 
-bool Token::is_punctuation (const char16_t c) {
-    for (int i = 0; i < sizeof(PUNCTUATION_CHARACTERS) / sizeof(char) - 1; ++i) {
-        if (c == PUNCTUATION_CHARACTERS[i]) {
-            return true;
+        c = body[i++];
+        switch (c) {
+            case 'b': result.push_back('\b'); break;
+            case 'f': result.push_back('\f'); break;
+            case 'n': result.push_back('\n'); break;
+            case 'r': result.push_back('\r'); break;
+            case 't': result.push_back('\t'); break;
+            case 'v': result.push_back('\v'); break;
+            case '\r':
+                if (i < body.size() && body[i] == '\n') {
+                    ++i;
+                }
+                break;
+            case '\n':
+                break;
+            case 'x': {
+                std::optional<char32_t> code_point = read_hex(2);
+                if (!code_point.has_value()) {
+                    return ERR_INVALID_ESCAPE;
+                }
+                append_code_point(*code_point, result);
+                break;
+            }
+            case 'u': {
+                std::optional<char32_t> read;
+                if (i < body.size() && body[i] == '{') {
+                    ++i;
+                    read = read_hex(0);
+                    if (i == body.size()) {
+                        return ERR_INVALID_ESCAPE;
+                    }
+                    ++i;  // The '}'.
+                } else {
+                    read = read_hex(4);
+                }
+                if (!read.has_value()) {
+                    return ERR_INVALID_ESCAPE;
+                }
+                char32_t code_point = *read;
+
+                // UTF-8 cannot hold the two halves of a pair apart, so they are put together first.
+                if (std::is_same_v<CharT, char> && code_point >= 0xd8'00 && code_point <= 0xdb'ff &&
+                    i + 6 <= body.size() && body[i] == '\\' && body[i + 1] == 'u') {
+                    size_t high_end = i;
+                    i += 2;
+                    std::optional<char32_t> low = read_hex(4);
+                    if (!low.has_value()) {
+                        return ERR_INVALID_ESCAPE;
+                    }
+                    if (*low >= 0xdc'00 && *low <= 0xdf'ff) {
+                        code_point = 0x1'00'00 + (((code_point & 0x3ffu) << 10u) | (*low & 0x3ffu));
+                    } else {
+                        i = high_end;
+                    }
+                }
+
+                append_code_point(code_point, result);
+                break;
+            }
+            case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7': {
+                // Legacy octal, which stops at three digits or at whatever would take it past \377.
+                char32_t code_point = c - '0';
+                size_t max_digits = c <= '3' ? 3 : 2;
+                for (size_t digits = 1; digits < max_digits && i < body.size() && body[i] >= '0' && body[i] <= '7';
+                     ++digits) {
+                    code_point = code_point * 8 + (body[i++] - '0');
+                }
+                append_code_point(code_point, result);
+                break;
+            }
+            default:
+                // U+2028 and U+2029 end lines too, and are three code units in UTF-8 (E2 80 A8 and E2 80 A9).
+                if constexpr (std::is_same_v<CharT, char>) {
+                    if ((uint8_t) c == 0xe2 && i + 1 < body.size() && (uint8_t) body[i] == 0x80 &&
+                        ((uint8_t) body[i + 1] == 0xa8 || (uint8_t) body[i + 1] == 0xa9)) {
+                        i += 2;
+                        break;
+                    }
+                } else {
+                    if (c == 0x20'28 || c == 0x20'29) {
+                        break;
+                    }
+                }
+                result.push_back(c);
+                break;
         }
     }
-    return false;
-}
 
-Token::Token (token_type_t type, token_subtype_t subtype, std::u16string::const_iterator begin,
-              std::u16string::const_iterator end, void* value_ptr)
-        : type(type), subtype(subtype), begin(begin), end(end), value_ptr(value_ptr) {
-    this->identifier_stack.reserve(IDENTIFIER_STACK_RESERVE);
+    return SUCCESS;
 }
 
-bool Token::cannot_precede_division () {
+template <typename CharT>
+BasicToken<CharT>::BasicToken (token_type_t type, token_subtype_t subtype, const_iterator begin,
+                               const_iterator end, token_value_t value)
+        : type(type), subtype(subtype), text(begin, end - begin), value(value) {}
+
+/**
+ * Whether a '/' right after this token would start a regex rather than be a division.
+ * @return Nothing if that is ambiguous, in which case the token before this one has to decide it.
+ */
+template <typename CharT>
+std::optional<bool> BasicToken<CharT>::cannot_precede_division () {
     if (this->type == EOL) {
         // Ambiguous, check before it.
-        throw 0;
+        return std::nullopt;
     }
 
     if (this->type == COMMENT) {
         // Ambiguous, check before it.
-        throw 0;
+        return std::nullopt;
     }
 
     if (this->type == EOS) {
@@ -97,11 +226,11 @@ bool Token::cannot_precede_division () {
     }
 
     if (this->type == OPERATOR) {
-        opcode_t opcode = *((opcode_t*) this->value_ptr);
+        opcode_t opcode = this->get_opcode();
 
         if (opcode & OP_UNARY) {  // ++ and --
             // Ambiguous. Postfix ones can precede division, prefix ones cannot.
-            throw 0;
+            return std::nullopt;
         }
 
         return opcode & OP_ASSIGNMENT ||
@@ -117,7 +246,7 @@ bool Token::cannot_precede_division () {
     }
 
     if (this->type == KEYWORD) {
-        opcode_t opcode = *((opcode_t*) this->value_ptr);
+        opcode_t opcode = this->get_opcode();
         return opcode & OP_KW_OPERATOR ||
                opcode & OP_KW_DECLARE ||  // All of those cannot precede either division or regex!
                opcode & OP_KW_BLOCK ||  // Some of those cannot precede eiter division or regex!
@@ -128,7 +257,8 @@ bool Token::cannot_precede_division () {
     return false;  // all have to preceed division.
 }
 
-std::string Token::to_string () {
+template <typename CharT>
+std::string BasicToken<CharT>::to_string () {
     using namespace srilakshmikanthanp;
     static const auto
             R = ansi::str(ansi::fg_red),
@@ -161,36 +291,88 @@ std::string Token::to_string () {
             J = K; break;
     }
 
-    return J + toUTF8(std::u16string(this->begin, this->end)) + K;
+    return J + toUTF8(std::basic_string<CharT>(this->text)) + K;
 }
 
-bool Token::is_whitespace () {
+template <typename CharT>
+bool BasicToken<CharT>::is_whitespace () {
     return this->type == WHITESPACE;
 }
 
-bool Token::is_comment () {
+template <typename CharT>
+bool BasicToken<CharT>::is_comment () {
     return this->type == COMMENT;
 }
 
-bool Token::is_discardable () {
-    return this->is_whitespace() || this->is_comment();
+template <typename CharT>
+bool BasicToken<CharT>::is_discardable () {
+    return is_discardable(this->type);
 }
 
-std::u16string::const_iterator Token::get_begin () {
-    return this->begin;
+template <typename CharT>
+bool BasicToken<CharT>::is_discardable (const token_type_t type) {
+    return type == WHITESPACE || type == COMMENT;
 }
 
-std::u16string::const_iterator Token::get_end () {
-    return this->end;
+template <typename CharT>
+token_type_t BasicToken<CharT>::get_type () const {
+    return this->type;
 }
 
+template <typename CharT>
+token_subtype_t BasicToken<CharT>::get_subtype () const {
+    return this->subtype;
+}
 
-std::string Token::colorized_output () {
-    std::string rv;
+template <typename CharT>
+token_value_t BasicToken<CharT>::get_value () const {
+    return this->value;
+}
 
-    for (auto& token: this->token_vector) {
-        rv += token.to_string();
-    }
+/**
+ * @return The opcode of an operator, keyword, parentheses, brackets or braces, that is, if tagged OPCODE_VALUE.
+ */
+template <typename CharT>
+opcode_t BasicToken<CharT>::get_opcode () const {
+    return this->value.opcode;
+}
 
-    return rv;
+/**
+ * @return The value of a number that is tagged INTEGER_VALUE.
+ */
+template <typename CharT>
+int64_t BasicToken<CharT>::get_integer () const {
+    return this->value.integer;
 }
+
+/**
+ * @return The value of a number that is tagged DOUBLE_VALUE.
+ */
+template <typename CharT>
+double BasicToken<CharT>::get_double () const {
+    return this->value.number;
+}
+
+template <typename CharT>
+bool BasicToken<CharT>::get_boolean () const {
+    return this->value.boolean;
+}
+
+/**
+ * @return The id of the identifier that an identifier token refers to, in the identifier table of its root.
+ */
+template <typename CharT>
+uint32_t BasicToken<CharT>::get_identifier () const {
+    return this->value.identifier;
+}
+
+/**
+ * @return The code units the token spans, in the buffer that it was tokenized from.
+ */
+template <typename CharT>
+std::basic_string_view<CharT> BasicToken<CharT>::get_text () const {
+    return this->text;
+}
+
+template class BasicToken<char16_t>;
+template class BasicToken<char>;
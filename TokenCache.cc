@@ -0,0 +1,302 @@
+#include <TokenCache.h>
+#include <Tokenizer.h>
+#include <SourceBuffer.h>
+#include <hash.h>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+template <typename CharT>
+BasicTokenCache<CharT>::BasicTokenCache (const char* directory, const uint64_t max_size)
+        : directory(directory), max_size(max_size) {}
+
+/**
+ * Creates the cache directory if it does not exist yet, and finds out how much it holds. Needs to be called before
+ * the cache is used.
+ * @return SUCCESS, or ERR_CACHE_UNAVAILABLE if the directory cannot be created or is not a directory.
+ */
+template <typename CharT>
+err_t BasicTokenCache<CharT>::open () {
+    struct stat st {};
+    const char* path = this->directory.c_str();
+    if ((mkdir(path, 0777) != 0 && errno != EEXIST) || stat(path, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        return ERR_CACHE_UNAVAILABLE;
+    }
+
+    this->size_estimate = this->scan(false);
+    return SUCCESS;
+}
+
+/**
+ * Looks up the tokens of the given content.
+ * @param content
+ * @return A root over content with the cached tokens, or nothing if they are not cached.
+ */
+template <typename CharT>
+std::optional<typename BasicTokenCache<CharT>::root_t>
+BasicTokenCache<CharT>::find (std::basic_string_view<CharT> content) {
+    const uint64_t hash = hash_content(content);
+    const std::string path = this->path_for(content, hash);
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+
+    SourceBuffer entry;
+    if (entry.load(fd) != SUCCESS) {
+        close(fd);
+        return std::nullopt;
+    }
+
+    // Marks the entry as recently used, so that it is among the last to be evicted.
+    futimens(fd, nullptr);
+    close(fd);
+
+    const char* data = entry.begin();
+    const size_t size = entry.size();
+
+    token_cache_header_t header;
+    if (size < sizeof(header)) {
+        return std::nullopt;
+    }
+    std::memcpy(&header, data, sizeof(header));
+
+    const size_t room = size - sizeof(header);
+    if (std::memcmp(header.magic, TOKEN_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.format_version != TOKEN_CACHE_FORMAT_VERSION || header.tokenizer_version != TOKENIZER_VERSION ||
+        header.code_unit_size != sizeof(CharT) || header.content_size != content.size() ||
+        header.content_hash != hash || header.token_count > room / sizeof(token_cache_record_t) ||
+        header.identifier_count > (room - header.token_count * sizeof(token_cache_record_t)) / sizeof(uint64_t)) {
+        return std::nullopt;
+    }
+
+    const char* records = data + sizeof(header);
+    const char* lengths = records + header.token_count * sizeof(token_cache_record_t);
+    const char* units = lengths + header.identifier_count * sizeof(uint64_t);
+    const char* const entry_end = data + size;
+
+    // Every identifier shows up in the content, so their code units cannot add up to more than the content has.
+    // That also keeps a damaged entry from interning more than an identifier table holds.
+    if ((uint64_t) (entry_end - units) / sizeof(CharT) > content.size()) {
+        return std::nullopt;
+    }
+
+    auto rv = root_t(ROOT, UNDEFINED, content.data(), content.data() + content.size(), token_value_t::none());
+
+    // Interning the identifiers in order gives each the id it was stored with, unless the entry repeats one.
+    // Every part of the entry is a multiple of 8 bytes long, so the code units are aligned.
+    rv.identifiers.reserve(header.identifier_count, (entry_end - units) / sizeof(CharT));
+    for (uint64_t i = 0; i < header.identifier_count; ++i) {
+        uint64_t length;
+        std::memcpy(&length, lengths + i * sizeof(uint64_t), sizeof(uint64_t));
+        if (length > (uint64_t) (entry_end - units) / sizeof(CharT)) {
+            return std::nullopt;
+        }
+
+        if (rv.identifiers.intern(std::basic_string_view<CharT>((const CharT*) units, length)) != i) {
+            return std::nullopt;
+        }
+        units += length * sizeof(CharT);
+    }
+
+    rv.token_vector.reserve(header.token_count);
+    for (uint64_t i = 0; i < header.token_count; ++i) {
+        token_cache_record_t record;
+        std::memcpy(&record, records + i * sizeof(record), sizeof(record));
+
+        if (record.begin > record.end || record.end > content.size()) {
+            return std::nullopt;
+        }
+
+        auto value = token_value_t::from_bits((token_value_tag_t) record.value_tag, record.value);
+        if (record.value_tag == IDENTIFIER_VALUE) {
+            if (record.value >= header.identifier_count) {
+                return std::nullopt;
+            }
+        } else if (record.value_tag > IDENTIFIER_VALUE) {
+            return std::nullopt;
+        }
+
+        rv.token_vector.emplace_back(record.type, record.subtype, content.data() + record.begin,
+                                     content.data() + record.end, value);
+    }
+
+    return rv;
+}
+
+/**
+ * Adds the tokens of the given content to the cache, and evicts old entries if the cache has grown too large.
+ * @param content
+ * @param root A root that was tokenized over content.
+ */
+template <typename CharT>
+void BasicTokenCache<CharT>::store (std::basic_string_view<CharT> content, root_t& root) {
+    const uint64_t hash = hash_content(content);
+    const std::string path = this->path_for(content, hash);
+
+    // Identifier values are already ids into the identifier table, which is stored along with the tokens.
+    std::vector<token_cache_record_t> records;
+    records.reserve(root.token_vector.size());
+
+    for (auto token: root.token_vector) {
+        token_cache_record_t record {};
+        record.type = (uint32_t) token.get_type();
+        record.subtype = (uint16_t) token.get_subtype();
+        auto text = token.get_text();
+        record.begin = text.data() - content.data();
+        record.end = record.begin + text.size();
+
+        // Decoded strings are ids into the string table of the root, which is not cached, so they are left out.
+        auto value = token.get_value();
+        if (value.tag == STRING_VALUE) {
+            value = token_value_t::none();
+        }
+        record.value_tag = value.tag;
+        record.value = value.bits;
+
+        records.push_back(record);
+    }
+
+    token_cache_header_t header {};
+    std::memcpy(header.magic, TOKEN_CACHE_MAGIC, sizeof(header.magic));
+    header.format_version = TOKEN_CACHE_FORMAT_VERSION;
+    header.tokenizer_version = TOKENIZER_VERSION;
+    header.code_unit_size = sizeof(CharT);
+    header.content_size = content.size();
+    header.content_hash = hash;
+    header.token_count = records.size();
+    header.identifier_count = root.identifiers.size();
+
+    std::string entry;
+    entry.append((const char*) &header, sizeof(header));
+    entry.append((const char*) records.data(), records.size() * sizeof(token_cache_record_t));
+    for (uint32_t id = 0; id < root.identifiers.size(); ++id) {
+        uint64_t length = root.identifiers[id].size();
+        entry.append((const char*) &length, sizeof(length));
+    }
+    for (uint32_t id = 0; id < root.identifiers.size(); ++id) {
+        entry.append((const char*) root.identifiers[id].data(), root.identifiers[id].size() * sizeof(CharT));
+    }
+
+    // Nobody else writes to this temporary file, and the rename replaces the entry in one step.
+    std::string temporary = path + "." + std::to_string(getpid()) + "." +
+                            std::to_string(this->temporary_counter++) + ".tmp";
+
+    int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        return;
+    }
+
+    size_t written = 0;
+    while (written < entry.size()) {
+        ssize_t n = write(fd, entry.data() + written, entry.size() - written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        written += n;
+    }
+
+    if (close(fd) != 0 || written != entry.size() || rename(temporary.c_str(), path.c_str()) != 0) {
+        unlink(temporary.c_str());
+        return;
+    }
+
+    // Only one thread evicts at a time. The others carry on, since it is going to make room for them too.
+    if ((this->size_estimate += entry.size()) > this->max_size && this->eviction.try_lock()) {
+        this->size_estimate = this->scan(true);
+        this->eviction.unlock();
+    }
+}
+
+template <typename CharT>
+std::string BasicTokenCache<CharT>::path_for (std::basic_string_view<CharT> content, const uint64_t hash) const {
+    char name[64];
+    std::snprintf(name, sizeof(name), "/%016" PRIx64 "-%zx-%zu" TOKEN_CACHE_EXTENSION,
+                  hash, content.size(), sizeof(CharT));
+    return this->directory + name;
+}
+
+/**
+ * Hashes the content, along with everything else that makes a cache entry of it unusable once it changes.
+ * @param content
+ * @return
+ */
+template <typename CharT>
+uint64_t BasicTokenCache<CharT>::hash_content (std::basic_string_view<CharT> content) {
+    const uint64_t seed = (uint64_t) TOKEN_CACHE_FORMAT_VERSION << 40u | (uint64_t) TOKENIZER_VERSION << 8u |
+                          sizeof(CharT);
+    return hash_bytes(content.data(), content.size() * sizeof(CharT), seed);
+}
+
+/**
+ * Adds up the size of every entry in the cache directory, and removes temporary files that were left behind.
+ * If evicting, and the entries add up to more than the maximum size, the least recently used ones are removed
+ * until they add up to at most three quarters of it.
+ * @param evict
+ * @return The size of the entries that are left, in bytes.
+ */
+template <typename CharT>
+uint64_t BasicTokenCache<CharT>::scan (const bool evict) {
+    typedef struct {
+        std::string name;
+        uint64_t size;
+        time_t used;
+    } cache_entry_t;
+
+    DIR* dir = opendir(this->directory.c_str());
+    if (dir == nullptr) {
+        return 0;
+    }
+
+    auto ends_with = [] (const std::string& name, std::string_view suffix) {
+        return name.size() >= suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+    };
+
+    std::vector<cache_entry_t> entries;
+    uint64_t total = 0;
+    const time_t now = std::time(nullptr);
+
+    while (dirent* item = readdir(dir)) {
+        std::string name = item->d_name;
+        struct stat st {};
+        if (fstatat(dirfd(dir), name.c_str(), &st, 0) != 0 || !S_ISREG(st.st_mode)) {
+            continue;
+        }
+
+        if (ends_with(name, ".tmp")) {
+            if (now - st.st_mtime > TOKEN_CACHE_STALE_TEMPORARY) {
+                unlinkat(dirfd(dir), name.c_str(), 0);
+            }
+        } else if (ends_with(name, TOKEN_CACHE_EXTENSION)) {
+            entries.push_back({std::move(name), (uint64_t) st.st_size, st.st_mtime});
+            total += st.st_size;
+        }
+    }
+
+    if (evict && total > this->max_size) {
+        std::sort(entries.begin(), entries.end(), [] (const cache_entry_t& a, const cache_entry_t& b) {
+            return a.used < b.used;
+        });
+
+        // Another process may be evicting the same entries, so one that is already gone still counts as removed.
+        for (auto& entry: entries) {
+            if (total <= this->max_size / 4 * 3) {
+                break;
+            }
+            unlinkat(dirfd(dir), entry.name.c_str(), 0);
+            total -= entry.size;
+        }
+    }
+
+    closedir(dir);
+    return total;
+}
+
+template class BasicTokenCache<char16_t>;
+template class BasicTokenCache<char>;
@@ -0,0 +1,240 @@
+#include <TokenFile.h>
+#include <Tokenizer.h>
+
+// Rounds a size in bytes up to a whole number of 8 byte words.
+#define TOKEN_FILE_ALIGN(n) (((n) + 7u) & ~(uint64_t) 7u)
+
+/**
+ * Maps a token file (or reads it, if it cannot be mapped) and checks that all of it can be safely read.
+ * @param file_name
+ * @return SUCCESS, or ERR_IFSTREAM_FAILED, or ERR_TOKEN_FILE_INVALID, in which case none of the getters may be used.
+ */
+template <typename CharT>
+err_t BasicTokenFile<CharT>::load (const char* file_name) {
+    if (err_t error = this->buffer.load(file_name)) {
+        return error;
+    }
+
+    return this->validate();
+}
+
+/**
+ * Writes out the tokens nested in a root as a token file.
+ * @param root A root that was tokenized over the content it ranges over, which no tokenizer makes any larger than
+ * TOKEN_FILE_MAX_CONTENT_SIZE code units.
+ * @return The bytes of the token file.
+ */
+template <typename CharT>
+std::string BasicTokenFile<CharT>::serialize (root_t& root) {
+    const CharT* content = root.get_text().data();
+    const uint64_t content_size = root.get_text().size();
+    if (content_size > TOKEN_FILE_MAX_CONTENT_SIZE) {
+        fail(ERR_TOKEN_FILE_TOO_LARGE);
+    }
+
+    std::vector<token_file_record_t> records;
+    std::vector<uint32_t> identifier_indices(root.identifiers.size(), UINT32_MAX);
+    std::vector<token_file_identifier_t> identifiers;
+    std::unordered_map<uint64_t, uint32_t> value_indices;
+    std::vector<uint64_t> values;
+
+    records.reserve(root.token_vector.size());
+    for (auto token: root.token_vector) {
+        serialize(token, content, records, identifier_indices, identifiers, value_indices, values);
+    }
+
+    token_file_header_t header {};
+    std::memcpy(header.magic, TOKEN_FILE_MAGIC, sizeof(header.magic));
+    header.format_version = TOKEN_FILE_FORMAT_VERSION;
+    header.tokenizer_version = TOKENIZER_VERSION;
+    header.code_unit_size = sizeof(CharT);
+    header.byte_order = TOKEN_FILE_BYTE_ORDER;
+    header.content_size = content_size;
+    header.token_count = records.size();
+    header.identifier_count = identifiers.size();
+    header.value_count = values.size();
+
+    const uint64_t content_bytes = (content_size + 1) * sizeof(CharT);
+
+    std::string rv;
+    rv.reserve(sizeof(header) + records.size() * sizeof(token_file_record_t) +
+               identifiers.size() * sizeof(token_file_identifier_t) + values.size() * sizeof(uint64_t) +
+               TOKEN_FILE_ALIGN(content_bytes));
+
+    rv.append((const char*) &header, sizeof(header));
+    rv.append((const char*) records.data(), records.size() * sizeof(token_file_record_t));
+    rv.append((const char*) identifiers.data(), identifiers.size() * sizeof(token_file_identifier_t));
+    rv.append((const char*) values.data(), values.size() * sizeof(uint64_t));
+    rv.append((const char*) content, content_size * sizeof(CharT));
+    // The '\0' after the content, and the padding up to the end of the last word.
+    rv.append(TOKEN_FILE_ALIGN(content_bytes) - content_size * sizeof(CharT), '\0');
+
+    return rv;
+}
+
+/**
+ * Appends the record of a token. The lexer does not nest tokens (ranges are single tokens), so a record has no
+ * descendants.
+ */
+template <typename CharT>
+void BasicTokenFile<CharT>::serialize (const token_t& token, const CharT* content,
+                                       std::vector<token_file_record_t>& records,
+                                       std::vector<uint32_t>& identifier_indices,
+                                       std::vector<token_file_identifier_t>& identifiers,
+                                       std::unordered_map<uint64_t, uint32_t>& value_indices,
+                                       std::vector<uint64_t>& values) {
+    token_file_record_t record {};
+    record.type = (uint32_t) token.get_type();
+    record.subtype = (uint16_t) token.get_subtype();
+    std::basic_string_view<CharT> text = token.get_text();
+    record.begin = (uint32_t) (text.data() - content);
+    record.end = (uint32_t) (record.begin + text.size());
+
+    auto value = token.get_value();
+    if (value.tag == IDENTIFIER_VALUE) {
+        // The root has interned the identifiers already, so their entries only need numbering in file order.
+        uint32_t& index = identifier_indices[value.identifier];
+        if (index == UINT32_MAX) {
+            index = (uint32_t) identifiers.size();
+            identifiers.push_back({record.begin, (uint32_t) text.size()});
+        }
+        record.value = index;
+    } else if (value.tag != NO_VALUE && value.tag != STRING_VALUE) {  // Decoded strings are decoded again if needed.
+        auto inserted = value_indices.emplace(value.bits, (uint32_t) values.size());
+        if (inserted.second) {
+            values.push_back(value.bits);
+        }
+        record.flags |= TOKEN_FILE_HAS_VALUE;
+        record.value = inserted.first->second;
+    }
+
+    records.push_back(record);
+}
+
+/**
+ * Checks the header against this build, the sections against the size of the file, and every record and
+ * identifier against the sections they point into, so that none of the getters can read out of bounds.
+ * @return SUCCESS, or ERR_TOKEN_FILE_INVALID.
+ */
+template <typename CharT>
+err_t BasicTokenFile<CharT>::validate () {
+    const char* data = this->buffer.begin();
+    const uint64_t size = this->buffer.size();
+
+    if (size < sizeof(this->header)) {
+        return ERR_TOKEN_FILE_INVALID;
+    }
+    std::memcpy(&this->header, data, sizeof(this->header));
+
+    auto& h = this->header;
+    if (std::memcmp(h.magic, TOKEN_FILE_MAGIC, sizeof(h.magic)) != 0 ||
+        h.format_version != TOKEN_FILE_FORMAT_VERSION || h.tokenizer_version != TOKENIZER_VERSION ||
+        h.code_unit_size != sizeof(CharT) || h.byte_order != TOKEN_FILE_BYTE_ORDER ||
+        h.content_size > TOKEN_FILE_MAX_CONTENT_SIZE) {
+        return ERR_TOKEN_FILE_INVALID;
+    }
+
+    // Each count is bounded by the size of the file first, so that adding up the sections cannot overflow.
+    uint64_t room = size - sizeof(h);
+    if (h.token_count > room / sizeof(token_file_record_t) ||
+        h.identifier_count > room / sizeof(token_file_identifier_t) || h.value_count > room / sizeof(uint64_t)) {
+        return ERR_TOKEN_FILE_INVALID;
+    }
+
+    const uint64_t records_offset = sizeof(h);
+    const uint64_t identifiers_offset = records_offset + h.token_count * sizeof(token_file_record_t);
+    const uint64_t values_offset = identifiers_offset + h.identifier_count * sizeof(token_file_identifier_t);
+    const uint64_t content_offset = values_offset + h.value_count * sizeof(uint64_t);
+
+    if (content_offset > size || TOKEN_FILE_ALIGN((h.content_size + 1) * sizeof(CharT)) != size - content_offset) {
+        return ERR_TOKEN_FILE_INVALID;
+    }
+
+    this->records = (const token_file_record_t*) (data + records_offset);
+    this->identifiers = (const token_file_identifier_t*) (data + identifiers_offset);
+    this->values = (const uint64_t*) (data + values_offset);
+    this->content = (const CharT*) (data + content_offset);
+
+    if (this->content[h.content_size] != '\0') {
+        return ERR_TOKEN_FILE_INVALID;
+    }
+
+    for (uint64_t i = 0; i < h.identifier_count; ++i) {
+        auto& identifier = this->identifiers[i];
+        if (identifier.begin > h.content_size || identifier.size > h.content_size - identifier.begin) {
+            return ERR_TOKEN_FILE_INVALID;
+        }
+    }
+
+    for (uint64_t i = 0; i < h.token_count; ++i) {
+        auto& record = this->records[i];
+        if (record.begin > record.end || record.end > h.content_size ||
+            record.descendants > h.token_count - i - 1 ||
+            (record.type == IDENTIFIER && record.value >= h.identifier_count) ||
+            ((record.flags & TOKEN_FILE_HAS_VALUE) && record.value >= h.value_count)) {
+            return ERR_TOKEN_FILE_INVALID;
+        }
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @return The number of records, which is the number of tokens nested in the root at any depth.
+ */
+template <typename CharT>
+size_t BasicTokenFile<CharT>::size () const {
+    return this->header.token_count;
+}
+
+template <typename CharT>
+const token_file_record_t& BasicTokenFile<CharT>::get_record (const size_t index) const {
+    return this->records[index];
+}
+
+/**
+ * @param index
+ * @return The index of the record after the given one and all the tokens nested in it, which is size() after
+ * the last one.
+ */
+template <typename CharT>
+size_t BasicTokenFile<CharT>::next_sibling (const size_t index) const {
+    return index + 1 + this->records[index].descendants;
+}
+
+template <typename CharT>
+std::basic_string_view<CharT> BasicTokenFile<CharT>::get_text (const size_t index) const {
+    auto& record = this->records[index];
+    return std::basic_string_view<CharT>(this->content + record.begin, record.end - record.begin);
+}
+
+template <typename CharT>
+std::basic_string_view<CharT> BasicTokenFile<CharT>::get_identifier (const uint32_t identifier) const {
+    auto& entry = this->identifiers[identifier];
+    return std::basic_string_view<CharT>(this->content + entry.begin, entry.size);
+}
+
+/**
+ * @param index The index of a record that has TOKEN_FILE_HAS_VALUE set.
+ * @return The bits of its value, to be read according to its type and subtype.
+ */
+template <typename CharT>
+uint64_t BasicTokenFile<CharT>::get_value (const size_t index) const {
+    return this->values[this->records[index].value];
+}
+
+/**
+ * @return The content the tokens range over. The code unit right after it is a '\0', so it can be tokenized as is.
+ */
+template <typename CharT>
+std::basic_string_view<CharT> BasicTokenFile<CharT>::get_content () const {
+    return std::basic_string_view<CharT>(this->content, this->header.content_size);
+}
+
+template <typename CharT>
+size_t BasicTokenFile<CharT>::get_identifier_count () const {
+    return this->header.identifier_count;
+}
+
+template class BasicTokenFile<char16_t>;
+template class BasicTokenFile<char>;
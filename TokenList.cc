@@ -0,0 +1,378 @@
+#include <TokenList.h>
+
+template <typename CharT>
+BasicTokenList<CharT>::BasicTokenList (const CharT* base, Arena* arena)
+        : base(base), types(arena), subtypes(arena), offsets(arena), lengths(arena), tags(arena), values(arena) {}
+
+template <typename CharT>
+size_t BasicTokenList<CharT>::size () const {
+    return this->types.size();
+}
+
+template <typename CharT>
+bool BasicTokenList<CharT>::empty () const {
+    return this->types.empty();
+}
+
+template <typename CharT>
+void BasicTokenList<CharT>::reserve (const size_t n) {
+    this->types.reserve(n);
+    this->subtypes.reserve(n);
+    this->offsets.reserve(n);
+    this->lengths.reserve(n);
+    this->tags.reserve(n);
+    this->values.reserve(n);
+}
+
+/**
+ * Makes room for the tokens of the input from the base up to end, at one per CODE_UNITS_PER_TOKEN code units. Once
+ * the list runs out of room, it makes room for as many tokens as the rest of the input is on course for, going by
+ * how many the code units before it came to, rather than doubling. Lists are in arenas, which never free what a list
+ * outgrows, so it is better to grow once by the right amount than to grow many times.
+ * @param end
+ */
+template <typename CharT>
+void BasicTokenList<CharT>::reserve_for (const CharT* const end) {
+    this->expected_end = end;
+    this->reserve(std::clamp<size_t>((end - this->base) / CODE_UNITS_PER_TOKEN, TOKEN_VECTOR_RESERVE,
+                                     TOKEN_RESERVE_MAX));
+}
+
+/**
+ * Makes room for as many tokens as the whole input is on course for, at the rate the code units up to lexed came to,
+ * and an eighth more, so that a denser stretch near the end does not have the list grow again. It grows by at least a
+ * quarter, so that a list that goes on past the end it expected (as a chunk of a parallel tokenize can) still only
+ * grows a few times.
+ * @param lexed The end of the last token that needs room.
+ * @param needed How many tokens the list needs room for, up to and including that one.
+ */
+template <typename CharT>
+void BasicTokenList<CharT>::reserve_ahead (const CharT* const lexed, const size_t needed) {
+    const uint64_t projected = (uint64_t) needed * (uint64_t) (this->expected_end - this->base) /
+                               std::max<uint64_t>(lexed - this->base, 1);
+    this->reserve(std::max<uint64_t>(projected + projected / 8, needed + needed / 4));
+}
+
+template <typename CharT>
+void BasicTokenList<CharT>::clear () {
+    this->expected_end = nullptr;
+    this->types.clear();
+    this->subtypes.clear();
+    this->offsets.clear();
+    this->lengths.clear();
+    this->tags.clear();
+    this->values.clear();
+}
+
+template <typename CharT>
+void BasicTokenList<CharT>::push_back (const token_t& token) {
+    auto text = token.get_text();
+    this->emplace_back(token.get_type(), token.get_subtype(), text.data(), text.data() + text.size(),
+                       token.get_value());
+}
+
+/**
+ * Appends a token without building it first. Its end has to be within UINT32_MAX code units of the base, which
+ * the tokenizers make sure of by turning larger inputs away before lexing them.
+ * @param type
+ * @param subtype
+ * @param begin
+ * @param end
+ * @param value
+ */
+template <typename CharT>
+void BasicTokenList<CharT>::emplace_back (const token_type_t type, const token_subtype_t subtype,
+                                          const CharT* const begin, const CharT* const end, const token_value_t value) {
+    if ((uint64_t) (end - this->base) > UINT32_MAX) {
+        fail(ERR_INPUT_TOO_LARGE);
+    }
+
+    if (this->expected_end != nullptr && this->types.size() == this->types.capacity()) {
+        this->reserve_ahead(end, this->size() + 1);
+    }
+
+    this->types.push_back((uint32_t) type);
+    this->subtypes.push_back((uint16_t) subtype);
+    this->offsets.push_back((uint32_t) (begin - this->base));
+    this->lengths.push_back((uint32_t) (end - begin));
+    this->tags.push_back(value.tag);
+    this->values.push_back(value.bits);
+}
+
+template <typename CharT>
+void BasicTokenList<CharT>::pop_back () {
+    this->types.pop_back();
+    this->subtypes.pop_back();
+    this->offsets.pop_back();
+    this->lengths.pop_back();
+    this->tags.pop_back();
+    this->values.pop_back();
+}
+
+template <typename CharT>
+typename BasicTokenList<CharT>::token_t BasicTokenList<CharT>::operator[] (const size_t index) const {
+    const CharT* begin = this->base + this->offsets[index];
+    return token_t(this->types[index], this->subtypes[index], begin, begin + this->lengths[index],
+                   this->get_value(index));
+}
+
+template <typename CharT>
+typename BasicTokenList<CharT>::token_t BasicTokenList<CharT>::back () const {
+    return (*this)[this->size() - 1];
+}
+
+template <typename CharT>
+typename BasicTokenList<CharT>::iterator BasicTokenList<CharT>::begin () const {
+    return iterator(this, 0);
+}
+
+template <typename CharT>
+typename BasicTokenList<CharT>::iterator BasicTokenList<CharT>::end () const {
+    return iterator(this, this->size());
+}
+
+/**
+ * Overwrites the token at index.
+ * @param index
+ * @param token
+ */
+template <typename CharT>
+void BasicTokenList<CharT>::set (const size_t index, const token_t& token) {
+    auto text = token.get_text();
+    if ((uint64_t) (text.data() + text.size() - this->base) > UINT32_MAX) {
+        fail(ERR_INPUT_TOO_LARGE);
+    }
+
+    this->types[index] = (uint32_t) token.get_type();
+    this->subtypes[index] = (uint16_t) token.get_subtype();
+    this->offsets[index] = (uint32_t) (text.data() - this->base);
+    this->lengths[index] = (uint32_t) text.size();
+    this->tags[index] = token.get_value().tag;
+    this->values[index] = token.get_value().bits;
+}
+
+/**
+ * Inserts the tokens first to last (not inclusive) of another list before position. Both lists need to range
+ * over the same buffer, but may have different bases.
+ * @param position
+ * @param other
+ * @param first
+ * @param last
+ */
+template <typename CharT>
+void BasicTokenList<CharT>::insert (const size_t position, const BasicTokenList& other,
+                                    const size_t first, const size_t last) {
+    if (this->expected_end != nullptr && last > first && this->size() + (last - first) > this->types.capacity()) {
+        this->reserve_ahead(other.base + other.offsets[last - 1] + other.lengths[last - 1],
+                            this->size() + (last - first));
+    }
+
+    this->types.insert(this->types.begin() + position,
+                       other.types.begin() + first, other.types.begin() + last);
+    this->subtypes.insert(this->subtypes.begin() + position,
+                          other.subtypes.begin() + first, other.subtypes.begin() + last);
+    this->offsets.insert(this->offsets.begin() + position,
+                        other.offsets.begin() + first, other.offsets.begin() + last);
+    this->lengths.insert(this->lengths.begin() + position,
+                         other.lengths.begin() + first, other.lengths.begin() + last);
+    this->tags.insert(this->tags.begin() + position,
+                      other.tags.begin() + first, other.tags.begin() + last);
+    this->values.insert(this->values.begin() + position,
+                        other.values.begin() + first, other.values.begin() + last);
+
+    if (other.base != this->base) {
+        this->shift(position, position + (last - first), other.base - this->base);
+    }
+}
+
+/**
+ * Removes the tokens first to last (not inclusive).
+ * @param first
+ * @param last
+ */
+template <typename CharT>
+void BasicTokenList<CharT>::erase (const size_t first, const size_t last) {
+    this->types.erase(this->types.begin() + first, this->types.begin() + last);
+    this->subtypes.erase(this->subtypes.begin() + first, this->subtypes.begin() + last);
+    this->offsets.erase(this->offsets.begin() + first, this->offsets.begin() + last);
+    this->lengths.erase(this->lengths.begin() + first, this->lengths.begin() + last);
+    this->tags.erase(this->tags.begin() + first, this->tags.begin() + last);
+    this->values.erase(this->values.begin() + first, this->values.begin() + last);
+}
+
+/**
+ * Moves the tokens first to last (not inclusive) by distance code units, for when the text they point into has
+ * moved relative to the base.
+ * @param first
+ * @param last
+ * @param distance
+ */
+template <typename CharT>
+void BasicTokenList<CharT>::shift (const size_t first, const size_t last, const std::ptrdiff_t distance) {
+    for (size_t i = first; i < last; ++i) {
+        this->offsets[i] += distance;
+    }
+}
+
+template <typename CharT>
+const CharT* BasicTokenList<CharT>::get_base () const {
+    return this->base;
+}
+
+/**
+ * Moves every token along with the base, for when the text they point into has moved as a whole.
+ * @param base
+ */
+template <typename CharT>
+void BasicTokenList<CharT>::set_base (const CharT* const base) {
+    this->base = base;
+}
+
+template <typename CharT>
+token_type_t BasicTokenList<CharT>::get_type (const size_t index) const {
+    return this->types[index];
+}
+
+template <typename CharT>
+token_subtype_t BasicTokenList<CharT>::get_subtype (const size_t index) const {
+    return this->subtypes[index];
+}
+
+/**
+ * @param index
+ * @return Where the token at index begins, in code units from the base.
+ */
+template <typename CharT>
+uint32_t BasicTokenList<CharT>::get_offset (const size_t index) const {
+    return this->offsets[index];
+}
+
+template <typename CharT>
+uint32_t BasicTokenList<CharT>::get_length (const size_t index) const {
+    return this->lengths[index];
+}
+
+template <typename CharT>
+std::basic_string_view<CharT> BasicTokenList<CharT>::get_text (const size_t index) const {
+    return std::basic_string_view<CharT>(this->base + this->offsets[index], this->lengths[index]);
+}
+
+template <typename CharT>
+token_value_t BasicTokenList<CharT>::get_value (const size_t index) const {
+    return token_value_t::from_bits(this->tags[index], this->values[index]);
+}
+
+template <typename CharT>
+void BasicTokenList<CharT>::set_value (const size_t index, const token_value_t value) {
+    this->tags[index] = value.tag;
+    this->values[index] = value.bits;
+}
+
+/**
+ * @return The bytes that the tokens take in the columns, leaving out whatever the columns have room for past them.
+ */
+template <typename CharT>
+size_t BasicTokenList<CharT>::get_size_in_bytes () const {
+    return this->size() * (sizeof(uint32_t) + sizeof(uint16_t) + sizeof(uint32_t) + sizeof(uint32_t) +
+                           sizeof(token_value_tag_t) + sizeof(uint64_t));
+}
+
+/**
+ * @param arena What the tokens and identifiers of the root are allocated from. A new arena is made if none is given.
+ */
+template <typename CharT>
+BasicRootToken<CharT>::BasicRootToken (token_type_t type, token_subtype_t subtype, const_iterator begin,
+                                       const_iterator end, token_value_t value, std::shared_ptr<Arena> arena)
+        : BasicToken<CharT>(type, subtype, begin, end, value),
+          arena(arena != nullptr ? std::move(arena) : std::make_shared<Arena>()),
+          token_vector(begin, this->arena.get()), identifiers(this->arena.get()), strings(this->arena.get()),
+          lines(this->arena.get()) {}
+
+template <typename CharT>
+std::string BasicRootToken<CharT>::colorized_output () {
+    std::string rv;
+
+    for (auto token: this->token_vector) {
+        rv += token.to_string();
+    }
+
+    return rv;
+}
+
+/**
+ * The value of the string literal at index, decoded the first time it is asked for (see Token::decode_string).
+ * @param index The index of a STRING token in the token vector.
+ * @return For a literal without escapes, the code units between its quotes, which are valid for as long as the
+ * root is. For any other, its value in the string table, which is only valid until the next string is decoded.
+ * Fails with ERR_INVALID_ESCAPE if the literal has an escape sequence that cannot be decoded.
+ */
+template <typename CharT>
+Result<std::basic_string_view<CharT>> BasicRootToken<CharT>::get_string (const size_t index) {
+    auto value = this->token_vector.get_value(index);
+    if (value.tag == STRING_VALUE) {
+        return this->strings[value.string];
+    }
+
+    auto text = this->token_vector.get_text(index);
+    auto body = text.substr(1, text.size() - 2);  // Without the quotes.
+    if (body.find('\\') == std::basic_string_view<CharT>::npos) {
+        return body;
+    }
+
+    if (err_t error = BasicToken<CharT>::decode_string(body, this->decoded)) {
+        return failure_t {error};
+    }
+
+    const uint32_t id = this->strings.intern(this->decoded);
+    this->token_vector.set_value(index, token_value_t::of_string(id));
+    return this->strings[id];
+}
+
+/**
+ * @param index The index of a token in the token vector.
+ * @return The line and column that the token starts at.
+ */
+template <typename CharT>
+text_position_t BasicRootToken<CharT>::get_position (const size_t index) {
+    return this->get_offset_position(this->token_vector.get_text(index).data() - this->text.data());
+}
+
+/**
+ * @param offset In code units from the start of the root.
+ * @return The line and column of the code unit at offset.
+ */
+template <typename CharT>
+text_position_t BasicRootToken<CharT>::get_offset_position (const size_t offset) {
+    if (this->lines.empty()) {
+        this->lines.build(this->text);
+    }
+
+    return this->lines.find(offset);
+}
+
+/**
+ * Adds up what the root holds on to, by what it is for (see memory_usage_t).
+ * @return
+ */
+template <typename CharT>
+memory_usage_t BasicRootToken<CharT>::memory_usage () const {
+    memory_usage_t rv;
+    rv.tokens = this->token_vector.get_size_in_bytes();
+    rv.identifiers = this->identifiers.get_size_in_bytes();
+    rv.strings = this->strings.get_size_in_bytes();
+    rv.lines = this->lines.get_size_in_bytes();
+    rv.source = this->source != nullptr ? this->text.size() * sizeof(CharT) : 0;
+
+    // Everything but the decode buffer is allocated from the arena, so whatever the arena holds past them is slack.
+    const size_t in_arena = rv.tokens + rv.identifiers + rv.strings + rv.lines;
+    const size_t capacity = this->arena->get_capacity();
+    rv.slack = (capacity > in_arena ? capacity - in_arena : 0) + this->decoded.capacity() * sizeof(CharT);
+
+    return rv;
+}
+
+template class BasicTokenList<char16_t>;
+template class BasicTokenList<char>;
+
+template class BasicRootToken<char16_t>;
+template class BasicRootToken<char>;
@@ -1,66 +1,72 @@
 #include <TokenTypeChecker.h>
 
-TokenTypeChecker::TokenTypeChecker (int log_handler (const char*, ...)) : log_handler(log_handler) {}
+template <typename CharT>
+TokenTypeChecker<CharT>::TokenTypeChecker (int log_handler (const char*, ...)) : log_handler(log_handler) {}
 
 /**
  * Once we know that we've encountered a symbol, we can process it using this method.
  * This method will change the position of this->tokenizer_iterator to after the identifier,
  * allowing us to continue processing.
- * @return
+ * @return The longest operator at this->tokenizer_iterator.
  */
-operator_t TokenTypeChecker::process_symbol () const {
+template <typename CharT>
+Result<operator_t> TokenTypeChecker<CharT>::process_symbol () const {
     // Reaching this point means that we have a punctuation symbol.
-    auto original_iterator = this->tokenizer_iterator;
     // We need to remain constant. Incrementing the operator is the job of the LiteralProcessor.
     auto temp = this->tokenizer_iterator;
 
-    // We check how many symbols are in a row.
-    // If more than 4, we set the maximum per single operator to 4.
-    // At the end of this loop, the token iterator will be on the character after the possible operator.
-    uint8_t operator_size = MAX_OPERATOR_SIZE;
-    while (Token::is_punctuation(*(++temp)) && --operator_size);
-
-    // We iterate operator size starting at the maximum, decrementing till we reach 1.
-    // We compare operator size from our current tokenizer iterator to everything in the opcode map of that size.
-    operator_size = temp - original_iterator;
-    opcode_t opcode = 0;
-    char16_t c_copy[MAX_OPERATOR_SIZE + 1];
-    std::char_traits<char16_t>::copy(c_copy, &(*original_iterator), operator_size);
-    c_copy[operator_size] = '\0';
-    while (true) {
-        try {
-            // We try to see if an operator of this length exists.
-            opcode = get_op_cstr_opcode_map(operator_size).at(c_copy);
-        } catch (const std::out_of_range& e) {
-            // If it's not found, then it must have been a little shorter.
-            if (operator_size == 0) {
-                // We hit an operator size of zero before finding anything, this should never happen, as the
-                // condition for getting into this function in the first place is finding a punctuation as per
-                // `if (Token::is_punctuation(*this->tokenizer_iterator))` in Tokenizer::process_next_token.
-                //
-                // Note that this is a throw not a return false because no user-provided input should ever
-                // trigger it. This throw is only triggerable by a change to the codebase that breaks things.
-                throw ERR_OPERATOR_INVALID_PUNC;
-            }
+    // We walk OPERATOR_DFA one character at a time, remembering the longest operator we have gone through, until
+    // no operator goes on with the next character. The '\0' after the input is in no operator, so we stop there at
+    // the latest, and no operator is longer than MAX_OPERATOR_SIZE.
+    operator_t rv = {OPCODE_NOOP, 0, OPERATOR_NO_ENTRY};
+    uint8_t state = 0;
+    for (uint8_t size = 1; size <= MAX_OPERATOR_SIZE; ++size, ++temp) {
+        const auto c = (std::make_unsigned_t<CharT>) *temp;
+        state = c < OPERATOR_DFA.columns.size() ? OPERATOR_DFA.next[state][OPERATOR_DFA.columns[c]] : 0;
+        if (state == 0) {
+            break;
+        }
 
-            c_copy[--operator_size] = '\0';
-            continue;
+        const uint8_t entry = OPERATOR_DFA.accepts[state];
+        if (entry != OPERATOR_NO_ENTRY) {
+            rv = {OPERATORS[entry].opcode, size, entry};
         }
-        break;
     }
 
-    return {opcode, operator_size};  // These get copied instead of passed by reference and I'm fine with it.
+    if (rv.size == 0) {
+        // We found no operator at all, this should never happen, as the condition for getting into this function
+        // in the first place is finding a punctuation as per
+        // `if (token_t::is_punctuation(*this->tokenizer_iterator))` in Tokenizer::process_next_token.
+        //
+        // Note that this is an error not a syntax error because no user-provided input should ever
+        // trigger it. This error is only triggerable by a change to the codebase that breaks things.
+        return failure_t {ERR_OPERATOR_INVALID_PUNC};
+    }
+
+    return rv;  // These get copied instead of passed by reference and I'm fine with it.
 }
 
-int64_t TokenTypeChecker::get_char_offset () const {
-    if (this->tokenizer_iterator == this->base_token->get_end() || *this->tokenizer_iterator == '\0') {
+template <typename CharT>
+int64_t TokenTypeChecker<CharT>::get_char_offset () const {
+    auto text = this->base_token->get_text();
+    if (this->tokenizer_iterator == text.data() + text.size() || *this->tokenizer_iterator == '\0') {
         return NOT_FOUND;  // This whole function needs to be signed, because NOT_FOUND is negative.
     }
 
-    return this->tokenizer_iterator - this->base_token->get_begin();
+    return this->tokenizer_iterator - text.data();
 }
 
-bool TokenTypeChecker::next_token_is_number () const {
+/**
+ * @return The end of what is being lexed, which no scan may go past.
+ */
+template <typename CharT>
+typename TokenTypeChecker<CharT>::token_t::const_iterator TokenTypeChecker<CharT>::get_input_end () const {
+    auto text = this->base_token->get_text();
+    return text.data() + text.size();
+}
+
+template <typename CharT>
+bool TokenTypeChecker<CharT>::next_token_is_number () const {
     auto temp = this->tokenizer_iterator;
 
     // If it starts with a negative sign, then we ignore it, since it might very well be a number.
@@ -76,9 +82,13 @@ bool TokenTypeChecker::next_token_is_number () const {
 
     // Falling back through from the optional negative sign and dot,
     // anything that starts with a digit is automatically a number.
-    return Token::is_digit(*temp);
+    return token_t::is_digit(*temp);
 }
 
-opcode_t TokenTypeChecker::next_token_is_keyword () const {
-    return Token::kw_cstr_to_opcode(&(*this->tokenizer_iterator));
+template <typename CharT>
+opcode_t TokenTypeChecker<CharT>::next_token_is_keyword () const {
+    return token_t::kw_cstr_to_opcode(this->tokenizer_iterator);
 }
+
+template class TokenTypeChecker<char16_t>;
+template class TokenTypeChecker<char>;
@@ -1,78 +1,216 @@
 #include <Tokenizer.h>
+#include <TokenCache.h>
+#include <scan.h>
 
 
-Tokenizer::Tokenizer (int log_handler (const char*, ...)) : LiteralProcessor(log_handler) {
+template <typename CharT>
+BasicTokenizer<CharT>::BasicTokenizer (int log_handler (const char*, ...)) : LiteralProcessor<CharT>(log_handler) {
     // Overload the constructor.
     this->expect(ANYTHING);
 }
 
 /**
  * Attempts to tokenize a given two iterators for the start and end of a string or string segment.
+ * The code unit at end must be readable and should be a '\0', as the lexer peeks past the last token.
  *
  * @param file_contents
- * @return
+ * @return The root, or ERR_TOKENIZING_SYNTAX_ERROR, or ERR_INPUT_TOO_LARGE for more than MAX_INPUT_SIZE code units.
  */
-Token
-Tokenizer::tokenize (const std::u16string::const_iterator& begin, const std::u16string::const_iterator& end) {
+template <typename CharT>
+Result<typename BasicTokenizer<CharT>::root_t> BasicTokenizer<CharT>::tokenize (const CharT* begin, const CharT* end) {
+    if ((uint64_t) (end - begin) > MAX_INPUT_SIZE) {
+        return failure_t {ERR_INPUT_TOO_LARGE};
+    }
+
     // We need to make a reference to what the previous base token and token iterator were.
     // This is so that recursive calls of this function can work properly.
     // This is similar to pushing to stack in the figurative sense.
     auto old_tokenizer_iterator = this->tokenizer_iterator;
     auto old_base_token = this->base_token;
+    token_type_t old_expecting[EXPECTING_BUFFER_N];
+    std::copy_n(this->expecting, EXPECTING_BUFFER_N, old_expecting);
+    auto old_expecting_iterator = this->expecting_iterator;
 
     this->tokenizer_iterator = begin;  // Copy assign begin and end here.
+    this->suspended_range.reset();  // Whatever ran out of input before has nothing to do with this input.
 
-    auto rv = Token(ROOT, UNDEFINED, begin, end, nullptr);
-    rv.token_vector.reserve(TOKEN_VECTOR_RESERVE);
+    // The last call to process_next_token leaves nothing expected, so we always start over from expecting anything.
+    this->expecting_iterator = 0;
+    this->expect(ANYTHING);
+
+    auto rv = root_t(ROOT, UNDEFINED, begin, end, token_value_t::none(), this->reuse_arena());
+    rv.token_vector.reserve_for(end);
 
     this->base_token = &rv;
 
     // Attempt to process the next token forever till process_next_token returns false.
-    // It will return false when done or when it encounters an error.
-    while (this->process_next_token());
+    // It will return false when done or when it encounters a syntax error, and fail on any other error.
+    Result<bool> processed = true;
+    while ((processed = this->process_next_token()) && *processed);
 
-    if (this->get_char_offset() != NOT_FOUND) {
-        throw ERR_TOKENIZING_SYNTAX_ERROR;
-    }
+    const bool complete = this->get_char_offset() == NOT_FOUND;
 
     // We return them as they were. You can consider this an action similar to popping a stack.
     this->tokenizer_iterator = old_tokenizer_iterator;
     this->base_token = old_base_token;
+    std::copy_n(old_expecting, EXPECTING_BUFFER_N, this->expecting);
+    this->expecting_iterator = old_expecting_iterator;
+
+    if (!processed) {
+        return failure_t {processed.get_error()};
+    }
+    if (!complete) {
+        return failure_t {ERR_TOKENIZING_SYNTAX_ERROR};
+    }
 
     return rv;
 }
 
+/**
+ * Hands out the arena of the last root that was tokenized, reset, if nothing holds on to that root anymore.
+ * Otherwise, a new arena is made for the next root. A tokenizer that is reused across many files, each of which
+ * is done with before the next one, thus keeps allocating from the same memory.
+ * @return
+ */
+template <typename CharT>
+std::shared_ptr<Arena> BasicTokenizer<CharT>::reuse_arena () {
+    if (this->arena != nullptr && this->arena.use_count() == 1) {
+        this->arena->reset();
+    } else {
+        this->arena = std::make_shared<Arena>();
+    }
+
+    return this->arena;
+}
+
 /**
  * Attempts to tokenize a given string, usually a file contents.
+ * Like for the iterator overload, str.end() must be readable, which it always is for a std::basic_string.
  * @param file_contents
  * @return
  */
-Token Tokenizer::tokenize (const std::u16string& str) {
-    return this->tokenize(str.begin(), str.end());
+template <typename CharT>
+Result<typename BasicTokenizer<CharT>::root_t> BasicTokenizer<CharT>::tokenize (std::basic_string_view<CharT> str) {
+    return this->tokenize(str.data(), str.data() + str.size());
 }
 
 /**
- * Simply reads a file and then attempts to tokenize it.
+ * Maps a file (or reads it, if it cannot be mapped) and then attempts to tokenize it.
+ * If there is a cache, and it has the tokens of the file, the file is not lexed at all.
+ * The root holds on to the contents of the file, so it stays valid after the next file is tokenized.
  * @param file_name
- * @return
+ * @return The root, or the error that the file failed to load or to tokenize with.
+ */
+template <typename CharT>
+Result<typename BasicTokenizer<CharT>::root_t> BasicTokenizer<CharT>::tokenize (const char* file_name) {
+    std::shared_ptr<const void> owner;
+    Result<std::basic_string_view<CharT>> content = this->load(file_name, owner);
+    if (!content) {
+        return failure_t {content.get_error()};
+    }
+
+    if (this->cache == nullptr) {
+        Result<root_t> rv = this->tokenize(*content);
+        if (rv) {
+            rv->source = std::move(owner);
+        }
+        return rv;
+    }
+
+    if (auto cached = this->cache->find(*content)) {
+        cached->source = std::move(owner);
+        return std::move(*cached);
+    }
+
+    Result<root_t> rv = this->tokenize(*content);
+    if (rv) {
+        this->cache->store(*content, *rv);
+        rv->source = std::move(owner);
+    }
+    return rv;
+}
+
+/**
+ * Sets a cache to look files up in before lexing them, and to add them to after. The cache is not owned.
+ * @param cache Can be nullptr, to stop using a cache.
  */
-Token Tokenizer::tokenize (const char* file_name) {
-    std::ifstream file(file_name, std::ios::binary | std::ios::in);
+template <typename CharT>
+void BasicTokenizer<CharT>::set_cache (BasicTokenCache<CharT>* cache) {
+    this->cache = cache;
+}
 
-    if (file.fail()) {
-        throw ERR_IFSTREAM_FAILED;
+/**
+ * Adds up what the tokenizer keeps between files, for the next file to reuse. Buffers that a root still holds on to
+ * are left out, as they are counted by the root (see BasicRootToken::memory_usage).
+ * @return Everything as source or slack, since none of it holds tokens until the next file is tokenized.
+ */
+template <typename CharT>
+memory_usage_t BasicTokenizer<CharT>::memory_usage () const {
+    memory_usage_t rv = {0, 0, 0, 0, 0, 0};
+
+    if (this->source != nullptr && this->source.use_count() == 1) {
+        rv.source += this->source->size();
+    }
+    if (this->transcoded != nullptr && this->transcoded.use_count() == 1) {
+        rv.source += this->transcoded->capacity() * sizeof(CharT);
+    }
+    if (this->arena != nullptr && this->arena.use_count() == 1) {
+        rv.slack += this->arena->get_capacity();
     }
 
-    if (file.is_open()) {
-        file.seekg(0, std::ios::beg);
-        auto tmp_u8_str = std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-        fromUTF8(tmp_u8_str, this->content);
+    return rv;
+}
 
-        file.close();
-        return this->tokenize(this->content);
+/**
+ * Maps a file (or reads it, if it cannot be mapped), and returns its contents as code units ready to be lexed.
+ *
+ * A UTF-8 tokenizer lexes the mapped bytes directly, out of this->source.
+ * Any other tokenizer transcodes the mapped bytes straight into this->transcoded, and drops the mapping before lexing.
+ * Either way, the code unit after the returned contents is a '\0'.
+ *
+ * The buffers of the last file are reused, unless a root tokenized from it still holds on to them, in which case
+ * this file is loaded into new ones.
+ * @param file_name
+ * @param owner Set to what holds the returned contents, for the root tokenized from them to hold on to.
+ * @return The contents, or ERR_IFSTREAM_FAILED, ERR_INVALID_UTF8, or ERR_INPUT_TOO_LARGE (see tokenize).
+ */
+template <typename CharT>
+Result<std::basic_string_view<CharT>>
+BasicTokenizer<CharT>::load (const char* file_name, std::shared_ptr<const void>& owner) {
+    if (this->source == nullptr || this->source.use_count() > 1) {
+        this->source = std::make_shared<SourceBuffer>();
+    }
+    if (err_t error = this->source->load(file_name)) {
+        return failure_t {error};
     }
 
-    throw ERR_IFSTREAM_FAILED;
+    // The size is checked before the cache is looked in, which would otherwise read back more than a root can hold.
+    if constexpr (std::is_same_v<CharT, char>) {
+        if (this->source->size() > MAX_INPUT_SIZE) {
+            return failure_t {ERR_INPUT_TOO_LARGE};
+        }
+
+        owner = this->source;
+        return std::basic_string_view<CharT>(this->source->begin(), this->source->size());
+    } else {
+        if (this->transcoded == nullptr || this->transcoded.use_count() > 1) {
+            this->transcoded = std::make_shared<std::basic_string<CharT>>();
+        }
+
+        int64_t invalid_offset = utf8_to_utf16(this->source->begin(), this->source->end(), *this->transcoded);
+        this->source->release();
+
+        if (invalid_offset != NOT_FOUND) {
+            this->log_handler("[ERROR] Invalid UTF-8 sequence at byte %" PRId64 " of %s.\n", invalid_offset, file_name);
+            return failure_t {ERR_INVALID_UTF8};
+        }
+        if (this->transcoded->size() > MAX_INPUT_SIZE) {
+            return failure_t {ERR_INPUT_TOO_LARGE};
+        }
+
+        owner = this->transcoded;
+        return std::basic_string_view<CharT>(*this->transcoded);
+    }
 }
 
 /**
@@ -82,9 +220,10 @@ Token Tokenizer::tokenize (const char* file_name) {
  *
  * If we are expecting a specific token type, and it discovers a token of a different type,
  * it just returns false (an inter-token syntax error).
- * @return
+ * @return Fails on anything that is not a syntax error.
  */
-bool Tokenizer::process_next_token () {
+template <typename CharT>
+Result<bool> BasicTokenizer<CharT>::process_next_token () {
     auto original_iterator = this->tokenizer_iterator;
     // Uses this->tokenizer_iterator to either process_identifier, process_number_literal, or process_symbol.
     bool rv = false;
@@ -97,25 +236,25 @@ bool Tokenizer::process_next_token () {
     }
 
     // If it's whitespace, we just skip past it and do nothing.
-    if (Token::is_whitespace(*this->tokenizer_iterator) && (expected_type & WHITESPACE)) {
-        while (Token::is_whitespace(*(++this->tokenizer_iterator)));
+    if (token_t::is_whitespace(*this->tokenizer_iterator) && (expected_type & WHITESPACE)) {
+        this->tokenizer_iterator = skip_whitespace(this->tokenizer_iterator + 1, this->get_input_end());
         this->base_token->token_vector.emplace_back(
-                WHITESPACE, UNDEFINED, original_iterator, this->tokenizer_iterator, nullptr);
+                WHITESPACE, UNDEFINED, original_iterator, this->tokenizer_iterator, token_value_t::none());
         rv = true;
         goto expect;
     }
 
     // If it's an EOL or EOS, we just skip past it and empalce it.
-    if (Token::is_line_terminator(*this->tokenizer_iterator) && (expected_type & EOL)) {
+    if (token_t::is_line_terminator(*this->tokenizer_iterator) && (expected_type & EOL)) {
         this->base_token->token_vector.emplace_back(
-                EOL, UNDEFINED, original_iterator, ++this->tokenizer_iterator, nullptr);
+                EOL, UNDEFINED, original_iterator, ++this->tokenizer_iterator, token_value_t::none());
         rv = true;
         goto expect;
     }
 
     if (*this->tokenizer_iterator == ';' && (expected_type & EOS)) {
         this->base_token->token_vector.emplace_back(
-                EOS, UNDEFINED, original_iterator, ++this->tokenizer_iterator, nullptr);
+                EOS, UNDEFINED, original_iterator, ++this->tokenizer_iterator, token_value_t::none());
         rv = true;
         goto expect;
     }
@@ -129,8 +268,12 @@ bool Tokenizer::process_next_token () {
 
     // Operators have to be processed before identifiers so that "var" and "let" do not end up being recognized
     // as identifiers.
-    if (Token::is_punctuation(*this->tokenizer_iterator)) {
-        rv = this->process_operator();
+    if (token_t::is_punctuation(*this->tokenizer_iterator)) {
+        Result<bool> processed = this->process_operator();
+        if (!processed) {
+            return processed;
+        }
+        rv = *processed;
         goto expect;
     }
 
@@ -143,7 +286,7 @@ bool Tokenizer::process_next_token () {
 
 
     // If it's an identifier, we process it.
-    if (Token::is_identifier(*this->tokenizer_iterator) && (expected_type & IDENTIFIER)) {
+    if (token_t::is_identifier(*this->tokenizer_iterator) && (expected_type & IDENTIFIER)) {
         rv = this->process_identifier();
         goto expect;
     }
@@ -160,3 +303,6 @@ bool Tokenizer::process_next_token () {
     // Returns false once done, or once any subprocess returns false, or if an error has been encountered.
     return rv;
 }
+
+template class BasicTokenizer<char16_t>;
+template class BasicTokenizer<char>;
@@ -0,0 +1,191 @@
+#include <SourceBuffer.h>
+#include <Token.h>
+#include <chrono>
+
+// Every pass is run this many times, and the fastest run is reported, as the others only add noise.
+#define BENCH_RUNS 7
+
+// How large the built-in corpus is, in bytes of UTF-8.
+#define CORPUS_SIZE 0x80'00'00
+
+// The predicates as they were before CHARACTER_CLASSES (see tests/character_class_test.cc), which the table is timed
+// against.
+
+static bool old_is_digit (const char16_t c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool old_is_identifier (const char16_t c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '$';
+}
+
+static bool old_is_whitespace (const char16_t c) {
+    for (size_t i = 0; i < sizeof(WHITESPACE_CHARACTERS) / sizeof(char) - 1; ++i) {
+        if (c == WHITESPACE_CHARACTERS[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool old_is_punctuation (const char16_t c) {
+    for (size_t i = 0; i < sizeof(PUNCTUATION_CHARACTERS) / sizeof(char) - 1; ++i) {
+        if (c == PUNCTUATION_CHARACTERS[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool old_is_line_terminator (const char16_t c) {
+    return c == '\r' || c == '\n';
+}
+
+/**
+ * Runs a pass BENCH_RUNS times.
+ * @return The fastest run, in milliseconds.
+ */
+template <typename F>
+static double best_of (F pass) {
+    double best = 0;
+    for (int i = 0; i < BENCH_RUNS; ++i) {
+        auto begin = std::chrono::steady_clock::now();
+        pass();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        best = i == 0 ? ms : std::min(best, ms);
+    }
+    return best;
+}
+
+/**
+ * Repeats a sample up to CORPUS_SIZE bytes.
+ */
+static std::string make_corpus (const std::string& sample) {
+    std::string rv;
+    while (rv.size() < CORPUS_SIZE) {
+        rv += sample;
+    }
+    return rv;
+}
+
+/**
+ * Drops every run of whitespace and line terminators, but for a single space between two identifier characters,
+ * which leaves the mix of code units that minified code has. Comments are left in, as nothing here lexes the result.
+ */
+static std::string minify (const std::string& source) {
+    std::string rv;
+    bool pending = false;
+    for (const char c: source) {
+        if (old_is_whitespace(c) || old_is_line_terminator(c)) {
+            pending = true;
+            continue;
+        }
+        if (pending && !rv.empty() && (old_is_identifier(rv.back()) || old_is_digit(rv.back())) &&
+            (old_is_identifier(c) || old_is_digit(c))) {
+            rv.push_back(' ');
+        }
+        pending = false;
+        rv.push_back(c);
+    }
+    return rv;
+}
+
+/**
+ * Classifies every code unit the way the lexer decides what a token starts with, and walks the runs of identifier
+ * characters the way it finds where an identifier ends, with both the class table and the old predicates.
+ * @return The number of failures, which is 0 or 1.
+ */
+template <typename CharT>
+static int bench (const char* name, const std::basic_string<CharT>& source) {
+    typedef BasicToken<CharT> token_t;
+    size_t classified[2][5] = {};
+    size_t identifier_units[2] = {};
+
+    double table = best_of([&] {
+        for (const CharT c: source) {
+            classified[0][token_t::is_whitespace(c) ? 0 : token_t::is_identifier(c) ? 1 : token_t::is_digit(c) ? 2 :
+                          token_t::is_line_terminator(c) ? 3 : token_t::is_punctuation(c) ? 4 : 0]++;
+        }
+    });
+    double old = best_of([&] {
+        for (const CharT c: source) {
+            classified[1][old_is_whitespace(c) ? 0 : old_is_identifier(c) ? 1 : old_is_digit(c) ? 2 :
+                          old_is_line_terminator(c) ? 3 : old_is_punctuation(c) ? 4 : 0]++;
+        }
+    });
+
+    double table_runs = best_of([&] {
+        for (size_t i = 0; i < source.size(); ++i) {
+            while (i < source.size() && token_t::is_in_class(source[i], CHAR_IDENTIFIER | CHAR_DIGIT)) {
+                ++identifier_units[0];
+                ++i;
+            }
+        }
+    });
+    double old_runs = best_of([&] {
+        for (size_t i = 0; i < source.size(); ++i) {
+            while (i < source.size() && (old_is_identifier(source[i]) || old_is_digit(source[i]))) {
+                ++identifier_units[1];
+                ++i;
+            }
+        }
+    });
+
+    // Both sides counted the same code units, so that neither could have been optimized away, and they agree.
+    bool agree = identifier_units[0] == identifier_units[1];
+    for (size_t i = 0; i < std::size(classified[0]); ++i) {
+        agree = agree && classified[0][i] == classified[1][i];
+    }
+    if (!agree) {
+        std::fprintf(stderr, "%s: the class table and the old predicates disagree\n", name);
+        return 1;
+    }
+
+    std::printf("%s: %zu code units of %zu bytes\n", name, source.size(), sizeof(CharT));
+    std::printf("  classify %.2f ms (old predicates %.2f ms)\n", table, old);
+    std::printf("  identifier runs %.2f ms (old predicates %.2f ms)\n", table_runs, old_runs);
+    return 0;
+}
+
+/**
+ * Benches a source and its minified form, in both code unit types.
+ * @return The number of failures.
+ */
+static int bench_all (const std::string& name, const std::string& source) {
+    int failures = 0;
+    for (const auto& [suffix, text]: {std::pair {"", source}, std::pair {", minified", minify(source)}}) {
+        std::u16string utf16;
+        if (fromUTF8(text, utf16) != SUCCESS) {
+            std::fprintf(stderr, "%s: %s\n", name.c_str(), errors[ERR_INVALID_UTF8]);
+            return failures + 1;
+        }
+        failures += bench((name + suffix + ", UTF-16").c_str(), utf16);
+        failures += bench((name + suffix + ", UTF-8").c_str(), text);
+    }
+    return failures;
+}
+
+// char_class_bench [FILE...]
+int main (int argc, const char** argv) {
+    // Code as it is usually written, indented, commented and spaced out.
+    int failures = bench_all("Typical", make_corpus(
+            "function render(items, options) {\n"
+            "    // Entries are sorted by date before they are drawn.\n"
+            "    const sorted = items.slice().sort((a, b) => a.date - b.date);\n"
+            "    for (let i = 0; i < sorted.length; ++i) {\n"
+            "        draw(sorted[i], { x: options.left, y: options.top + i * 20, label: 'entry' });\n"
+            "    }\n"
+            "}\n"));
+
+    for (int i = 1; i < argc; ++i) {
+        SourceBuffer buffer;
+        if (buffer.load(argv[i]) != SUCCESS) {
+            std::fprintf(stderr, "%s: %s\n", argv[i], errors[ERR_IFSTREAM_FAILED]);
+            ++failures;
+            continue;
+        }
+        failures += bench_all(argv[i], std::string(buffer.begin(), buffer.size()));
+    }
+
+    return failures != 0;
+}
@@ -0,0 +1,107 @@
+#include <TokenFile.h>
+#include <Tokenizer.h>
+#include <chrono>
+#include <unistd.h>
+
+// Every phase is run this many times, and the fastest run is reported, as the others only add noise.
+#define BENCH_RUNS 7
+
+/**
+ * Runs a phase BENCH_RUNS times.
+ * @return The fastest run, in milliseconds.
+ */
+template <typename F>
+static double best_of (F phase) {
+    double best = 0;
+    for (int i = 0; i < BENCH_RUNS; ++i) {
+        auto begin = std::chrono::steady_clock::now();
+        phase();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        best = i == 0 ? ms : std::min(best, ms);
+    }
+    return best;
+}
+
+/**
+ * Compares writing a token file of a source, and loading it back, with tokenizing the source again.
+ * @return The number of failures, which is 0 or 1.
+ */
+template <typename CharT>
+static int bench (const std::basic_string<CharT>& source) {
+    BasicTokenizer<CharT> tokenizer(null_io_handler);
+    Result<BasicRootToken<CharT>> root = tokenizer.tokenize(source);
+    if (!root) {
+        std::fprintf(stderr, "%s\n", errors[root.get_error()]);
+        return 1;
+    }
+
+    char file_name[] = "/tmp/m6_token_file_bench_XXXXXX";
+    int fd = mkstemp(file_name);
+    if (fd == -1) {
+        std::fprintf(stderr, "%s\n", errors[ERR_OFSTREAM_FAILED]);
+        return 1;
+    }
+    close(fd);
+
+    std::string bytes;
+    size_t walked = 0;  // Kept, so that walking the records cannot be optimized away.
+
+    double lex = best_of([&] { (void) tokenizer.tokenize(source); });
+    double serialize = best_of([&] { bytes = BasicTokenFile<CharT>::serialize(*root); });
+    double write = best_of([&] {
+        std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), (std::streamsize) bytes.size()).flush();
+    });
+    double load = best_of([&] {
+        BasicTokenFile<CharT> file;
+        if (file.load(file_name) != SUCCESS) {
+            std::abort();
+        }
+    });
+
+    BasicTokenFile<CharT> file;
+    err_t error = file.load(file_name);
+    unlink(file_name);
+    if (error != SUCCESS) {
+        std::fprintf(stderr, "%s\n", errors[error]);
+        return 1;
+    }
+
+    double walk = best_of([&] {
+        for (size_t i = 0; i < file.size(); i = file.next_sibling(i)) {
+            walked += file.get_record(i).type + file.get_text(i).size();
+        }
+    });
+
+    std::printf("%zu code units of %zu bytes, %zu tokens, %zu distinct identifiers, a token file of %zu bytes\n",
+                source.size(), sizeof(CharT), file.size(), file.get_identifier_count(), bytes.size());
+    std::printf("lex %.2f ms\nserialize %.2f ms\nwrite %.2f ms\nmap + check %.2f ms\nwalk tokens %.2f ms\n",
+                lex, serialize, write, load, walk);
+    return walked == 0;
+}
+
+// token_file_bench FILE [--utf8]
+int main (int argc, const char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "%s\n", errors[ERR_INVALID_ARGC]);
+        return 1;
+    }
+
+    SourceBuffer buffer;
+    if (buffer.load(argv[1]) != SUCCESS) {
+        std::fprintf(stderr, "%s\n", errors[ERR_IFSTREAM_FAILED]);
+        return 1;
+    }
+    std::string source(buffer.begin(), buffer.size());
+
+    if (argc > 2 && std::strcmp(argv[2], "--utf8") == 0) {
+        return bench(source);
+    }
+
+    std::u16string utf16;
+    if (fromUTF8(source, utf16) != SUCCESS) {
+        std::fprintf(stderr, "%s\n", errors[ERR_INVALID_UTF8]);
+        return 1;
+    }
+    return bench(utf16);
+}
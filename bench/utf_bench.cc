@@ -0,0 +1,138 @@
+#include <SourceBuffer.h>
+#include <utf.h>
+#include <chrono>
+#include <codecvt>
+#include <cstring>
+#include <locale>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Every conversion is run this many times, and the fastest run is reported, as the others only add noise.
+#define BENCH_RUNS 7
+
+// How large each of the built-in corpora is, in bytes of UTF-8.
+#define CORPUS_SIZE 0x80'00'00
+
+/**
+ * Runs a conversion BENCH_RUNS times.
+ * @return The fastest run, in milliseconds.
+ */
+template <typename F>
+static double best_of (F conversion) {
+    double best = 0;
+    for (int i = 0; i < BENCH_RUNS; ++i) {
+        auto begin = std::chrono::steady_clock::now();
+        conversion();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        best = i == 0 ? ms : std::min(best, ms);
+    }
+    return best;
+}
+
+/**
+ * Repeats a sample up to CORPUS_SIZE bytes.
+ */
+static std::string make_corpus (const std::string& sample) {
+    std::string rv;
+    while (rv.size() < CORPUS_SIZE) {
+        rv += sample;
+    }
+    return rv;
+}
+
+/**
+ * Times both directions of the transcoders against the std::wstring_convert path they replaced, which is
+ * deprecated, but still the baseline to beat.
+ * @return The number of failures, which is 0 or 1.
+ */
+static int bench (const char* name, const std::string& utf8) {
+    std::u16string utf16;
+    if (fromUTF8(utf8, utf16) != SUCCESS) {
+        std::fprintf(stderr, "%s: %s\n", name, errors[ERR_INVALID_UTF8]);
+        return 1;
+    }
+
+    std::u16string to_utf16;
+    std::string to_utf8;
+    size_t converted = 0;  // Kept, so that the conversions cannot be optimized away.
+
+    double widen = best_of([&] {
+        to_utf16.clear();
+        converted += utf8_to_utf16(utf8.data(), utf8.data() + utf8.size(), to_utf16) == NOT_FOUND;
+    });
+    double narrow = best_of([&] {
+        to_utf8.clear();
+        converted += utf16_to_utf8(utf16.data(), utf16.data() + utf16.size(), to_utf8) == NOT_FOUND;
+    });
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+    std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t> convertor;
+    double old_widen = best_of([&] { converted += convertor.from_bytes(utf8).size(); });
+    double old_narrow = best_of([&] { converted += convertor.to_bytes(utf16).size(); });
+#pragma GCC diagnostic pop
+
+    std::printf("%s: %zu bytes, %zu code units\n", name, utf8.size(), utf16.size());
+    std::printf("  utf8_to_utf16 %.2f ms (wstring_convert %.2f ms)\n", widen, old_widen);
+    std::printf("  utf16_to_utf8 %.2f ms (wstring_convert %.2f ms)\n", narrow, old_narrow);
+    return converted == 0;
+}
+
+/**
+ * Runs every bench in a process of its own, since the transcoders pick their kernels once per process, the first
+ * time they are used.
+ * @return The number of failures.
+ */
+static int run_benches (int argc, const char** argv, bool disable_avx2) {
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid == -1) {
+        return 1;
+    }
+
+    if (pid == 0) {
+        if (disable_avx2) {
+            setenv("M6_DISABLE_AVX2", "1", 1);
+        } else {
+            unsetenv("M6_DISABLE_AVX2");
+        }
+        std::printf("%s\n", disable_avx2 ? "M6_DISABLE_AVX2=1" : "As is");
+
+        // Code, with the odd accented letter in its comments and strings.
+        int failures = bench("ASCII-heavy", make_corpus(
+                "function render(items, options) {\n"
+                "    // Résumé entries are sorted by date before they are drawn.\n"
+                "    const sorted = items.slice().sort((a, b) => a.date - b.date);\n"
+                "    for (let i = 0; i < sorted.length; ++i) {\n"
+                "        draw(sorted[i], { x: options.left, y: options.top + i * 20, label: 'café' });\n"
+                "    }\n"
+                "}\n"));
+
+        // Localized strings, mostly three-byte sequences, with the odd emoji for the four-byte ones.
+        failures += bench("CJK-heavy", make_corpus(
+                "const 消息 = {标题: '欢迎使用我们的应用程序', 说明: '请在下面输入您的用户名和密码', "
+                "错误: '無効なパスワードです。もう一度お試しください', 完成: '저장되었습니다 🎉'};\n"));
+
+        for (int i = 1; i < argc; ++i) {
+            SourceBuffer buffer;
+            if (buffer.load(argv[i]) != SUCCESS) {
+                std::fprintf(stderr, "%s: %s\n", argv[i], errors[ERR_IFSTREAM_FAILED]);
+                ++failures;
+                continue;
+            }
+            failures += bench(argv[i], std::string(buffer.begin(), buffer.size()));
+        }
+
+        std::fflush(stdout);
+        _exit(failures);
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
+
+// utf_bench [FILE...]
+int main (int argc, const char** argv) {
+    return run_benches(argc, argv, false) + run_benches(argc, argv, true) != 0;
+}
@@ -1,11 +1,38 @@
 #include <errors.h>
+#include <cstdio>
+#include <cstdlib>
 
 const char errors[ERR_COUNT + 1][MAX_ERR_SIZE] = {
         "",
         "[ERROR] Input file stream failed to read the file %s.",
-        "[ERROR] Wrong number of arguments. Expected only one argument, the file name to interpret.",
+        "[ERROR] Wrong arguments. Usage: m6 [--utf8] [--parallel] [-j N] [--cache DIR] [--cache-size BYTES] [--binary] [--mem-report] [--files-from LIST] FILE... | -",
         "[ERROR] A syntax error has been found while tokenizing.",
         "[ERROR] The size of the operator needs to be between 1 and 4, or 0 for checking all operators.",
         "[ERROR] The operator does not start with a punctuation yet we somehow made it to process_symbol.",
         "[ERROR] Please set the token iterator to some start operator before calling find_end_of_start_operator.",
+        "[ERROR] The input is not valid UTF-8.",
+        "[ERROR] A token is not valid UTF-16 and cannot be converted to UTF-8 for output.",
+        "[ERROR] Something other than an m6 error was thrown while processing the file.",
+        "[ERROR] An edit reaches past the end of the buffer it is applied to.",
+        "[ERROR] The cache directory cannot be created or is not a directory.",
+        "[ERROR] The file is not a token file of this version and code unit size, or it is damaged.",
+        "[ERROR] The file is too large to be written as a token file.",
+        "[ERROR] Output file stream failed to write the output of %s.",
+        "[ERROR] The input is longer than 4 GiB code units, which is more than a token list can hold.",
+        "[ERROR] A string literal has an invalid escape sequence.",
 };
+
+/**
+ * Raises an error that only a caller breaking the contract of a function can run into, like handing a token list
+ * more than it can hold. Anything that input alone can cause is returned instead. The error is thrown, or, without
+ * exceptions, written to stderr before aborting.
+ * @param error
+ */
+void fail (const err_t error) {
+#ifdef M6_EXCEPTIONS
+    throw error;
+#else
+    std::fprintf(stderr, "%s\n", errors[error]);
+    std::abort();
+#endif
+}
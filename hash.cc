@@ -0,0 +1,35 @@
+#include <hash.h>
+
+#define HASH_P0 0xa0'76'1d'64'78'bd'64'2fu
+#define HASH_P1 0xe7'03'7e'd1'a0'b4'28'dbu
+#define HASH_P2 0x8e'bc'6a'f0'9c'88'c6'e3u
+
+// Multiplies the two words, and folds the high half of the product into the low half.
+static inline uint64_t fold (const uint64_t a, const uint64_t b) {
+    __uint128_t product = (__uint128_t) a * b;
+    return (uint64_t) product ^ (uint64_t) (product >> 64u);
+}
+
+uint64_t hash_bytes (const void* const data, const size_t size, uint64_t seed) {
+    auto bytes = (const uint8_t*) data;
+    seed ^= HASH_P0;
+
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        uint64_t a, b;
+        std::memcpy(&a, bytes + i, 8);
+        std::memcpy(&b, bytes + i + 8, 8);
+        seed = fold(a ^ HASH_P1, b ^ seed);
+    }
+
+    // Whatever is left (up to 15 bytes) is zero-padded into one last block.
+    uint64_t a = 0, b = 0;
+    size_t left = size - i;
+    std::memcpy(&a, bytes + i, std::min(left, (size_t) 8));
+    if (left > 8) {
+        std::memcpy(&b, bytes + i + 8, left - 8);
+    }
+    seed = fold(a ^ HASH_P1, b ^ seed);
+
+    return fold(seed ^ HASH_P2, size ^ HASH_P1);
+}
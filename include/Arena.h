@@ -0,0 +1,102 @@
+#ifndef M6_ARENA_H
+#define M6_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// The size of the first chunk of an arena, in bytes. Every chunk after it is twice as large as the one before.
+#define ARENA_CHUNK_SIZE ((size_t) 0x01'00'00)
+
+typedef struct arena_chunk_t {
+    arena_chunk_t* previous;
+    size_t size;  // In bytes, this header included.
+} arena_chunk_t;
+
+/*
+ * A monotonic bump allocator, which holds everything a tokenized file is made of, so that all of it is freed at
+ * once when the file is done with.
+ *
+ * Memory is handed out of chunks that double in size, and is never given back one allocation at a time. Resetting
+ * an arena makes all of its memory free again. If it had grown past a single chunk, its chunks are replaced by one
+ * chunk as large as all of them, so an arena that is reset between files of similar size settles into a single
+ * chunk that it never has to grow, and tearing it down is a single free.
+ */
+class Arena {
+public:
+    Arena () = default;
+
+    Arena (const Arena&) = delete;
+
+    Arena& operator= (const Arena&) = delete;
+
+    ~Arena ();
+
+    [[nodiscard]] void* allocate (size_t size, size_t alignment);
+
+    void reset ();
+
+    [[nodiscard]] size_t get_capacity () const;
+
+protected:
+    void release ();
+
+    void grow (size_t size);
+
+    arena_chunk_t* last = nullptr;
+    char* cursor = nullptr;
+    char* limit = nullptr;
+};
+
+/*
+ * An allocator over an arena, for standard containers. Deallocating does nothing, as the arena frees everything at
+ * once. Without an arena, it allocates and frees on the heap like std::allocator.
+ *
+ * The allocator moves along with the memory of a container when the container is moved or swapped, so a container
+ * that is moved into another one keeps allocating from the arena that its memory is in.
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    ArenaAllocator (Arena* arena = nullptr) noexcept : arena(arena) {}
+
+    template <typename U>
+    ArenaAllocator (const ArenaAllocator<U>& other) noexcept : arena(other.get_arena()) {}
+
+    [[nodiscard]] T* allocate (size_t n) {
+        return this->arena != nullptr ? (T*) this->arena->allocate(n * sizeof(T), alignof(T)) :
+               (T*) ::operator new(n * sizeof(T));
+    }
+
+    void deallocate (T* p, size_t) noexcept {
+        if (this->arena == nullptr) {
+            ::operator delete(p);
+        }
+    }
+
+    [[nodiscard]] Arena* get_arena () const noexcept { return this->arena; }
+
+    template <typename U>
+    bool operator== (const ArenaAllocator<U>& other) const noexcept { return this->arena == other.get_arena(); }
+
+    template <typename U>
+    bool operator!= (const ArenaAllocator<U>& other) const noexcept { return this->arena != other.get_arena(); }
+
+protected:
+    Arena* arena;
+};
+
+template <typename T>
+using arena_vector = std::vector<T, ArenaAllocator<T>>;
+
+template <typename CharT>
+using arena_basic_string = std::basic_string<CharT, std::char_traits<CharT>, ArenaAllocator<CharT>>;
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef M6_BATCHTOKENIZER_H
+#define M6_BATCHTOKENIZER_H
+
+#include <Tokenizer.h>
+#include <functional>
+
+// How many files each worker may run ahead of the oldest file whose result has not been handed out yet.
+// This bounds how many finished results are held in memory while waiting for a slow file.
+#define BATCH_WINDOW_PER_JOB 4
+
+/*
+ * Tokenizes many files on a pool of worker threads, each with a Tokenizer of its own.
+ *
+ * The renderer runs on the worker right after a file is tokenized (while its tokens are still valid), and turns
+ * them into whatever output is wanted. The results are then handed to the sink on the calling thread, in the same
+ * order as the file names were given, no matter which worker finished first, along with how much memory the root
+ * took once it was rendered (see memory_usage_t).
+ *
+ * An error in one file is passed to the sink along with that file, and does not affect any other file.
+ */
+template <typename CharT>
+class BasicBatchTokenizer {
+public:
+    typedef BasicRootToken<CharT> root_t;
+    typedef std::function<std::string (root_t& root)> renderer_t;
+    typedef std::function<void (const std::string& file_name, const std::string& output, err_t error,
+                                const memory_usage_t& memory)> sink_t;
+
+    BasicBatchTokenizer (int log_handler (const char*, ...), size_t jobs);
+
+    size_t run (const std::vector<std::string>& file_names, const renderer_t& renderer, const sink_t& sink);
+
+    void set_cache (BasicTokenCache<CharT>* cache);
+
+protected:
+    int (* log_handler) (const char*, ...);
+    size_t jobs;
+    BasicTokenCache<CharT>* cache = nullptr;  // Shared by every worker, if set.
+};
+
+typedef BasicBatchTokenizer<char16_t> BatchTokenizer;
+typedef BasicBatchTokenizer<char> Utf8BatchTokenizer;
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef M6_IDENTIFIERTABLE_H
+#define M6_IDENTIFIERTABLE_H
+
+#include <Arena.h>
+#include <string_view>
+
+// How many slots the hash table starts with, once the first identifier is interned. It is never more than half
+// full, so this many slots hold half as many identifiers before it has to grow.
+#define IDENTIFIER_TABLE_SLOTS  0x00'01'00
+#define EMPTY_SLOT              UINT32_MAX
+
+/*
+ * Interns the identifiers of a root, numbering every distinct identifier with a dense 32-bit id in the order they
+ * first show up. Identifier tokens hold the id as their value.
+ *
+ * The code units of every identifier are appended to a single pool, and looked up through an open-addressing hash
+ * table (linear probing, never more than half full) of ids into it, so resolving an identifier costs the same no
+ * matter how many distinct identifiers came before it. Nothing is allocated until the first identifier is interned.
+ *
+ * Ids stay valid for as long as the table does. The views that the table hands out only stay valid until the next
+ * identifier is interned, as the pool may move when it grows.
+ */
+template <typename CharT>
+class BasicIdentifierTable {
+public:
+    explicit BasicIdentifierTable (Arena* arena = nullptr);
+
+    BasicIdentifierTable (const BasicIdentifierTable&) = delete;
+
+    BasicIdentifierTable& operator= (const BasicIdentifierTable&) = delete;
+
+    BasicIdentifierTable (BasicIdentifierTable&&) = default;
+
+    BasicIdentifierTable& operator= (BasicIdentifierTable&&) = default;
+
+    [[nodiscard]] uint32_t intern (std::basic_string_view<CharT> identifier);
+
+    [[nodiscard]] std::basic_string_view<CharT> operator[] (uint32_t id) const;
+
+    [[nodiscard]] size_t size () const;
+
+    [[nodiscard]] bool empty () const;
+
+    void reserve (size_t identifier_count, size_t code_unit_count);
+
+    void clear ();
+
+    [[nodiscard]] size_t get_size_in_bytes () const;
+
+protected:
+    [[nodiscard]] static size_t hash (std::basic_string_view<CharT> identifier);
+
+    void rehash (size_t slot_count);
+
+    arena_vector<CharT> pool;  // The code units of every identifier, one after the other.
+    arena_vector<uint32_t> ends;  // Where each identifier ends in the pool, and the next one begins.
+    arena_vector<uint32_t> slots;  // Ids, or EMPTY_SLOT. The size is always a power of two.
+};
+
+typedef BasicIdentifierTable<char16_t> IdentifierTable;
+typedef BasicIdentifierTable<char> Utf8IdentifierTable;
+
+#endif
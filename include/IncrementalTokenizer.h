@@ -0,0 +1,59 @@
+#ifndef M6_INCREMENTALTOKENIZER_H
+#define M6_INCREMENTALTOKENIZER_H
+
+#include <Tokenizer.h>
+
+/* Describes how the tokens of the root changed after an edit: starting at index first, removed tokens of the
+ * previous tree were replaced by the inserted tokens now in the tree. Every token after them was kept as it was,
+ * other than being moved along with its text.
+ */
+typedef struct {
+    size_t first;
+    size_t removed;
+    size_t inserted;
+} token_diff_t;
+
+/*
+ * Keeps a copy of a buffer along with its tokens, and keeps both up to date as the buffer is edited.
+ *
+ * An edit is only lexed from the last token it could have affected, and only until the new tokens line up with
+ * the previous ones again, at a token that the regex lookbehind never looks past. Everything after that is kept,
+ * so lexing an edit costs as much as the tokens it touches (and whatever range token it falls in), rather than
+ * the whole buffer. The result is the same as tokenizing the edited buffer from scratch, except that the
+ * identifier table still holds identifiers that may have since been edited away.
+ *
+ * If an edit leaves the buffer with a syntax error, the edit is still applied to the buffer, but there are no
+ * tokens until an edit fixes it. The diff for that edit then replaces every token the caller was last told about.
+ *
+ * The root and its tokens stay valid until the next edit.
+ */
+template <typename CharT>
+class BasicIncrementalTokenizer : public BasicTokenizer<CharT> {
+public:
+    using typename BasicTokenizer<CharT>::token_t;
+    using typename BasicTokenizer<CharT>::root_t;
+
+    explicit BasicIncrementalTokenizer (int log_handler (const char*, ...));
+
+    Result<root_t*> tokenize (std::basic_string_view<CharT> str);
+
+    Result<token_diff_t> edit (size_t offset, size_t removed, std::basic_string_view<CharT> inserted);
+
+    [[nodiscard]] root_t& get_root ();
+
+    [[nodiscard]] std::basic_string_view<CharT> get_content () const;
+
+protected:
+    [[nodiscard]] static bool same_token (const token_t& a, const token_t& b);
+
+    [[nodiscard]] static bool stops_lookbehind (token_t token);
+
+    std::basic_string<CharT> content;  // The buffer being edited, which the root ranges over.
+    std::optional<root_t> root;  // Empty while the buffer has a syntax error.
+    size_t reported = 0;  // How many tokens the caller was last told about.
+};
+
+typedef BasicIncrementalTokenizer<char16_t> IncrementalTokenizer;
+typedef BasicIncrementalTokenizer<char> Utf8IncrementalTokenizer;
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef M6_LINEINDEX_H
+#define M6_LINEINDEX_H
+
+#include <Arena.h>
+#include <string_view>
+
+typedef struct {
+    uint32_t line;  // Counted from 1.
+    uint32_t column;  // Counted from 1, in code units (bytes, for UTF-8).
+} text_position_t;
+
+/*
+ * The offset at which every line of a buffer starts, for turning offsets into lines and columns.
+ *
+ * Lines end at a LF, a CR, a CR LF (which is a single line terminator), a U+2028 or a U+2029. The buffer is scanned
+ * once, skipping 16 bytes at a time (with SSE2, or 8 bytes at a time otherwise) over code units that cannot start a
+ * line terminator. Every lookup is then a binary search over the line starts.
+ */
+template <typename CharT>
+class BasicLineIndex {
+public:
+    explicit BasicLineIndex (Arena* arena = nullptr);
+
+    void build (std::basic_string_view<CharT> text);
+
+    void clear ();
+
+    [[nodiscard]] bool empty () const;
+
+    [[nodiscard]] text_position_t find (size_t offset) const;
+
+    [[nodiscard]] size_t get_line_count () const;
+
+    [[nodiscard]] uint32_t get_line_start (uint32_t line) const;
+
+    [[nodiscard]] size_t get_size_in_bytes () const;
+
+protected:
+    arena_vector<uint32_t> line_starts;  // Empty until the index is built, and then always starts with 0.
+};
+
+typedef BasicLineIndex<char16_t> LineIndex;
+typedef BasicLineIndex<char> Utf8LineIndex;
+
+#endif
@@ -6,12 +6,28 @@
 #define LOG_EXPECTING_BUFFER_N ((uint8_t) 2)
 #define EXPECTING_BUFFER_N ((uint8_t) 1 << LOG_EXPECTING_BUFFER_N)
 
-class LiteralProcessor : public TokenTypeChecker {
+/* Remembers how far parse_range got into a range that ran out of input before it was closed, so that
+ * a streaming tokenizer can resume the scan once more input arrives instead of rescanning the whole range.
+ * The offset is counted from the start operator of the range.
+ */
+typedef struct {
+    opcode_t opcode;
+    int64_t nesting_level;
+    int64_t offset;
+} range_progress_t;
+
+template <typename CharT>
+class LiteralProcessor : public TokenTypeChecker<CharT> {
 public:
-    using TokenTypeChecker::TokenTypeChecker;
+    using typename TokenTypeChecker<CharT>::token_t;
+    using typename TokenTypeChecker<CharT>::root_t;
+    using TokenTypeChecker<CharT>::TokenTypeChecker;
 protected:
     token_type_t expecting[EXPECTING_BUFFER_N] {};
     uint8_t expecting_iterator = 0;
+    std::optional<range_progress_t> suspended_range;
+    bool lookbehind_exhausted = false;  // Set once next_token_is_regex runs out of tokens to look behind at.
+    bool intern_identifiers = true;  // Otherwise, identifier tokens hold no value, and their text tells them apart.
 
     void expect (token_type_t t);
 
@@ -19,15 +35,17 @@ protected:
 
     bool process_number_literal ();
 
+    token_value_t resolve_identifier (std::basic_string_view<CharT> identifier);
+
     bool process_identifier ();
 
     bool process_keyword (opcode_t memoized);
 
-    bool process_operator ();
+    Result<bool> process_operator ();
 
-    bool parse_range (const std::optional<operator_t> memoized);
+    Result<bool> parse_range (const std::optional<operator_t> memoized);
 
-    bool next_token_is_regex (const std::optional<operator_t> memoized);
+    Result<bool> next_token_is_regex (const std::optional<operator_t> memoized);
 };
 
 
@@ -0,0 +1,62 @@
+#ifndef M6_PARALLELTOKENIZER_H
+#define M6_PARALLELTOKENIZER_H
+
+#include <Tokenizer.h>
+
+// Inputs are not split into chunks smaller than this many code units, since a thread costs more than lexing them.
+#define PARALLEL_MIN_CHUNK_SIZE ((size_t) 0x01'00'00)
+
+/*
+ * Tokenizes a single large input on several threads, with the same result as BasicTokenizer::tokenize.
+ *
+ * The input is split into chunks at line starts that look like the start of a top level statement. The first chunk
+ * is lexed for real, while every other chunk is lexed on a thread of its own, on the guess that its split point is
+ * a token boundary in plain code: nothing expected but ANYTHING, and no tokens behind it.
+ *
+ * The chunks are then stitched together in order. A chunk's tokens are only taken as they are if the tokens before
+ * it end exactly at its split point in that state, and none of its regex decisions looked behind its first token.
+ * Otherwise, the guess was wrong (the split point was inside a string, comment, template, regex or bracket), and the
+ * chunk is lexed again right after the tokens before it, just like the serial tokenizer would.
+ *
+ * Since bracket ranges are single tokens, an input that is mostly one range (like a bundle wrapped in a function)
+ * gets no speedup, but still the same result.
+ */
+template <typename CharT>
+class BasicParallelTokenizer : public BasicTokenizer<CharT> {
+public:
+    using typename BasicTokenizer<CharT>::token_t;
+    using typename BasicTokenizer<CharT>::root_t;
+
+    BasicParallelTokenizer (int log_handler (const char*, ...), size_t jobs);
+
+    Result<root_t> tokenize (const char* file_name);
+
+    Result<root_t> tokenize (std::basic_string_view<CharT> str);
+
+    Result<root_t> tokenize (const CharT* begin, const CharT* end);
+
+protected:
+    typedef struct {
+        std::optional<root_t> root;  // Holds the tokens and identifiers of the chunk.
+        const CharT* stop;  // Where the lexer stopped, at or past the end of the chunk.
+        token_type_t expecting[EXPECTING_BUFFER_N];
+        uint8_t expecting_iterator;
+        bool valid;  // Whether the chunk was lexed up to its end without a syntax error.
+        bool exhausted;  // Whether a regex decision needed tokens from before the chunk.
+    } speculation_t;
+
+    const CharT* find_split (const CharT* target, const CharT* limit);
+
+    void speculate (const CharT* begin, const CharT* stop, const CharT* end, speculation_t& speculation);
+
+    void adopt (speculation_t& speculation);
+
+    Result<bool> lex_until (const CharT* stop);
+
+    size_t jobs;
+};
+
+typedef BasicParallelTokenizer<char16_t> ParallelTokenizer;
+typedef BasicParallelTokenizer<char> Utf8ParallelTokenizer;
+
+#endif
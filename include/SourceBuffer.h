@@ -0,0 +1,55 @@
+#ifndef M6_SOURCEBUFFER_H
+#define M6_SOURCEBUFFER_H
+
+#include <toplev.h>
+
+/*
+ * Holds the raw bytes of a source file.
+ *
+ * Regular files are memory-mapped read-only and hinted for sequential access, so no copy of the file is made
+ * before the tokenizer gets to it. Anything that cannot be mapped (pipes, character devices, empty files)
+ * falls back to a buffered read into a heap buffer.
+ *
+ * In both cases, the byte at end() is guaranteed to be '\0', because the tokenizer peeks one code unit past
+ * the end of its input the same way it would on a std::basic_string.
+ */
+class SourceBuffer {
+public:
+    SourceBuffer () = default;
+
+    SourceBuffer (const SourceBuffer&) = delete;
+
+    SourceBuffer& operator= (const SourceBuffer&) = delete;
+
+    SourceBuffer (SourceBuffer&& other) noexcept;
+
+    SourceBuffer& operator= (SourceBuffer&& other) noexcept;
+
+    ~SourceBuffer ();
+
+    [[nodiscard]] err_t load (const char* file_name);
+
+    [[nodiscard]] err_t load (int fd);
+
+    void release ();
+
+    [[nodiscard]] const char* begin () const;
+
+    [[nodiscard]] const char* end () const;
+
+    [[nodiscard]] size_t size () const;
+
+    [[nodiscard]] bool is_mapped () const;
+
+protected:
+    bool map (int fd, size_t file_size);
+
+    err_t read_all (int fd);
+
+    const char* data = nullptr;
+    size_t data_size = 0;
+    size_t mapping_size = 0;  // Zero if the data is not memory-mapped.
+    std::vector<char> buffer;  // Only used by the buffered-read fallback.
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef M6_STREAMTOKENIZER_H
+#define M6_STREAMTOKENIZER_H
+
+#include <Tokenizer.h>
+#include <functional>
+
+/*
+ * Tokenizes input that arrives in chunks, and hands every token to a handler as soon as it is complete.
+ *
+ * Only the unfinished tail of the input is kept between chunks. A token is held back until enough input has
+ * arrived after it to be sure nothing could still change it, unless a line feed or a ';' has arrived after it,
+ * which no token reaches past. That way, a statement is handed out as soon as the chunk that ends it arrives.
+ * Strings, comments and nested ranges that are cut by a chunk boundary resume their scan where it stopped.
+ *
+ * Memory is bounded by the chunk size plus the longest single token. Identifiers are not interned, as the table would
+ * grow with every distinct identifier in the whole input, and the ids would mean nothing to the handler anyway, so
+ * identifier tokens hold no value, and their text is what tells them apart.
+ *
+ * Tokens passed to the handler point into the internal buffer, and are only valid until the handler returns.
+ */
+template <typename CharT>
+class BasicStreamTokenizer : public BasicTokenizer<CharT> {
+public:
+    using typename BasicTokenizer<CharT>::token_t;
+    using typename BasicTokenizer<CharT>::root_t;
+    typedef std::function<void (token_t&)> token_handler_t;
+
+    BasicStreamTokenizer (int log_handler (const char*, ...), token_handler_t token_handler);
+
+    [[nodiscard]] err_t feed (const CharT* data, size_t size);
+
+    [[nodiscard]] err_t feed (std::basic_string_view<CharT> str);
+
+    [[nodiscard]] err_t feed_utf8 (const char* data, size_t size);
+
+    [[nodiscard]] err_t finish ();
+
+    void reset ();
+
+protected:
+    err_t process_pending (bool final);
+
+    [[nodiscard]] bool is_settled (root_t& root, size_t token_count, const CharT* last_terminator);
+
+    void trim_history ();
+
+    token_handler_t token_handler;
+
+    std::basic_string<CharT> pending;  // Starts at the first token that is not complete yet.
+    // The last few tokens, which next_token_is_regex looks behind at. It is moved into the root of every chunk and
+    // back out of it, and is on the heap rather than in an arena, since it is trimmed and grown for as long as the
+    // stream goes on.
+    BasicTokenList<CharT> history;
+    BasicTokenList<CharT> kept;  // What trim_history keeps of the history, which the two then swap.
+    std::string undecoded;  // The start of a UTF-8 sequence that was cut off by the end of the last chunk.
+};
+
+typedef BasicStreamTokenizer<char16_t> StreamTokenizer;
+typedef BasicStreamTokenizer<char> Utf8StreamTokenizer;
+
+#endif
@@ -1,12 +1,22 @@
 #ifndef M6_TOKEN_H
 #define M6_TOKEN_H
 
+#include <Arena.h>
 #include <opcodes.h>
+#include <utf.h>
+#include <array>
 
-#define IDENTIFIER_STACK_RESERVE     0x00'00'80
 #define PUNCTUATION_CHARACTERS "/?.>,<'\":]}[{=+-)(*&^%!`~"
 #define WHITESPACE_CHARACTERS "\t\r\v\f "
 
+// Character classes, as bits of the entries of CHARACTER_CLASSES. Every class is ASCII only.
+#define CHAR_DIGIT            ((char_class_t) (1u << 0u))  // 0 to 9.
+#define CHAR_HEXADECIMAL      ((char_class_t) (1u << 1u))  // a to f and A to F, without the digits.
+#define CHAR_IDENTIFIER       ((char_class_t) (1u << 2u))  // a to z, A to Z, _ and $.
+#define CHAR_WHITESPACE       ((char_class_t) (1u << 3u))  // WHITESPACE_CHARACTERS.
+#define CHAR_PUNCTUATION      ((char_class_t) (1u << 4u))  // PUNCTUATION_CHARACTERS.
+#define CHAR_LINE_TERMINATOR  ((char_class_t) (1u << 5u))  // CR and LF.
+
 #define NOTHING      ((token_type_t) 0)
 #define ANYTHING     ((token_type_t) -1)
 #define VALUE_TOKEN  ((token_type_t) (1u << 31u))
@@ -75,30 +85,142 @@
 typedef uint64_t token_type_t;
 typedef uint64_t token_subtype_t;
 
+typedef uint8_t char_class_t;
+
+/**
+ * Builds the class of every ASCII code unit, so that classifying a code unit is a single lookup.
+ * @return
+ */
+constexpr std::array<char_class_t, 0x80> make_character_classes () {
+    std::array<char_class_t, 0x80> rv = {};
+
+    for (char c = '0'; c <= '9'; ++c) {
+        rv[c] |= CHAR_DIGIT;
+    }
+    for (char c = 'a'; c <= 'z'; ++c) {
+        rv[c] |= CHAR_IDENTIFIER | (c <= 'f' ? CHAR_HEXADECIMAL : 0);
+        rv[c - 'a' + 'A'] |= CHAR_IDENTIFIER | (c <= 'f' ? CHAR_HEXADECIMAL : 0);
+    }
+    rv['_'] |= CHAR_IDENTIFIER;
+    rv['$'] |= CHAR_IDENTIFIER;
+    for (char c: std::string_view(WHITESPACE_CHARACTERS)) {
+        rv[c] |= CHAR_WHITESPACE;
+    }
+    for (char c: std::string_view(PUNCTUATION_CHARACTERS)) {
+        rv[c] |= CHAR_PUNCTUATION;
+    }
+    rv['\r'] |= CHAR_LINE_TERMINATOR;
+    rv['\n'] |= CHAR_LINE_TERMINATOR;
+
+    return rv;
+}
+
+inline constexpr std::array<char_class_t, 0x80> CHARACTER_CLASSES = make_character_classes();
+
+// What the value of a token holds.
+#define NO_VALUE          ((token_value_tag_t) 0)  // Whitespace, EOL, EOS, strings, templates, regex, comments, roots.
+#define OPCODE_VALUE      ((token_value_tag_t) 1)  // Operators, keywords, parentheses, brackets and braces.
+#define INTEGER_VALUE     ((token_value_tag_t) 2)  // Numbers with an INT_ subtype.
+#define DOUBLE_VALUE      ((token_value_tag_t) 3)  // Numbers with a FLOAT_ subtype.
+#define BOOLEAN_VALUE     ((token_value_tag_t) 4)
+#define IDENTIFIER_VALUE  ((token_value_tag_t) 5)  // Identifiers, unless streamed (see StreamTokenizer.h).
+#define STRING_VALUE      ((token_value_tag_t) 6)  // Strings with escapes, once their value has been asked for.
+
+typedef uint8_t token_value_tag_t;
 
-class Token {
+/*
+ * The decoded value of a token, as a tagged union that is held in the token itself, so that no token allocates
+ * anything of its own. bits is the whole of whichever member the tag says is set, which is how token lists and
+ * cache entries store values.
+ */
+struct token_value_t {
+    token_value_tag_t tag;
+    union {
+        opcode_t opcode;
+        int64_t integer;
+        double number;
+        bool boolean;
+        uint32_t identifier;  // The id of the identifier in the identifier table of the root.
+        uint32_t string;  // The id of the decoded string in the string table of the root.
+        uint64_t bits;
+    };
+
+    [[nodiscard]] static token_value_t none () { return from_bits(NO_VALUE, 0); }
+
+    [[nodiscard]] static token_value_t of_opcode (opcode_t opcode) { return from_bits(OPCODE_VALUE, opcode); }
+
+    [[nodiscard]] static token_value_t of_integer (int64_t integer) {
+        return from_bits(INTEGER_VALUE, (uint64_t) integer);
+    }
+
+    [[nodiscard]] static token_value_t of_double (double number) {
+        token_value_t rv = none();
+        rv.tag = DOUBLE_VALUE;
+        rv.number = number;
+        return rv;
+    }
+
+    [[nodiscard]] static token_value_t of_boolean (bool boolean) { return from_bits(BOOLEAN_VALUE, boolean); }
+
+    [[nodiscard]] static token_value_t of_identifier (uint32_t identifier) {
+        return from_bits(IDENTIFIER_VALUE, identifier);
+    }
+
+    [[nodiscard]] static token_value_t of_string (uint32_t string) { return from_bits(STRING_VALUE, string); }
+
+    [[nodiscard]] static token_value_t from_bits (token_value_tag_t tag, uint64_t bits) {
+        token_value_t rv;
+        rv.tag = tag;
+        rv.bits = bits;
+        return rv;
+    }
+};
+
+
+/*
+ * A token over a buffer of CharT code units. Tokens are small values, and the tokens in a root are kept in the
+ * columns of a BasicTokenList (see TokenList.h) rather than as tokens, so these are mostly built on the spot.
+ * The lexer is instantiated for char16_t (Token, fed from a transcoded std::u16string) and for char (Utf8Token,
+ * fed straight from UTF-8 bytes).
+ *
+ * Every character class the lexer cares about is ASCII, and no byte of a multi-byte UTF-8 sequence is ever
+ * in the ASCII range, so non-ASCII text inside strings, templates, regexes and comments passes through
+ * as opaque code units and never has to be decoded.
+ */
+template <typename CharT>
+class BasicToken {
 public:
-    Token (token_type_t type, token_subtype_t subtype,
-           std::u16string::const_iterator begin, std::u16string::const_iterator end,
-           void* value_ptr);
+    typedef const CharT* const_iterator;
+
+    BasicToken (token_type_t type, token_subtype_t subtype,
+                const_iterator begin, const_iterator end,
+                token_value_t value);
 
-    [[nodiscard]] static bool is_digit (char16_t c);
+    // Whether c is in any of classes. Code units past ASCII are in none, which also covers the bytes of multi-byte
+    // UTF-8 sequences, since a char that is widened to char16_t is either ASCII or past it.
+    [[nodiscard]] static bool is_in_class (char16_t c, char_class_t classes) {
+        return c < CHARACTER_CLASSES.size() && (CHARACTER_CLASSES[c] & classes);
+    }
 
-    [[nodiscard]] static bool is_hexadecimal_digit (char16_t c);
+    [[nodiscard]] static bool is_digit (char16_t c) { return is_in_class(c, CHAR_DIGIT); }
 
-    [[nodiscard]] static bool is_identifier (char16_t c);
+    [[nodiscard]] static bool is_hexadecimal_digit (char16_t c) { return is_in_class(c, CHAR_HEXADECIMAL); }
 
-    [[nodiscard]] static bool is_whitespace (char16_t c);
+    [[nodiscard]] static bool is_identifier (char16_t c) { return is_in_class(c, CHAR_IDENTIFIER); }
 
-    [[nodiscard]] static bool is_punctuation (char16_t c);
+    [[nodiscard]] static bool is_whitespace (char16_t c) { return is_in_class(c, CHAR_WHITESPACE); }
 
-    [[nodiscard]] static bool is_line_terminator (char16_t c);
+    [[nodiscard]] static bool is_punctuation (char16_t c) { return is_in_class(c, CHAR_PUNCTUATION); }
 
-    [[nodiscard]] static opcode_t kw_cstr_to_opcode (const char16_t* c);
+    [[nodiscard]] static bool is_line_terminator (char16_t c) { return is_in_class(c, CHAR_LINE_TERMINATOR); }
+
+    [[nodiscard]] static opcode_t kw_cstr_to_opcode (const CharT* c);
 
     [[nodiscard]] static const char16_t* kw_opcode_to_cstr (opcode_t keyword_opcode);
 
-    [[nodiscard]] bool cannot_precede_division ();
+    [[nodiscard]] static err_t decode_string (std::basic_string_view<CharT> body, std::basic_string<CharT>& result);
+
+    [[nodiscard]] std::optional<bool> cannot_precede_division ();
 
     [[nodiscard]] std::string to_string ();
 
@@ -108,21 +230,34 @@ public:
 
     [[nodiscard]] bool is_discardable ();
 
-    [[nodiscard]] std::u16string::const_iterator get_begin ();
+    [[nodiscard]] static bool is_discardable (token_type_t type);
+
+    [[nodiscard]] token_type_t get_type () const;
+
+    [[nodiscard]] token_subtype_t get_subtype () const;
+
+    [[nodiscard]] token_value_t get_value () const;
 
-    [[nodiscard]] std::u16string::const_iterator get_end ();
+    [[nodiscard]] opcode_t get_opcode () const;
 
-    std::string colorized_output ();
+    [[nodiscard]] int64_t get_integer () const;
+
+    [[nodiscard]] double get_double () const;
+
+    [[nodiscard]] bool get_boolean () const;
+
+    [[nodiscard]] uint32_t get_identifier () const;
+
+    [[nodiscard]] std::basic_string_view<CharT> get_text () const;
 
-    std::vector<Token> token_vector;
-    std::vector<std::u16string> identifier_stack;
-    Token* parent;
 protected:
-    const token_type_t type;
-    const token_subtype_t subtype;
-    const std::u16string::const_iterator begin;  // Inclusive.
-    const std::u16string::const_iterator end;  // Not inclusive.
-    void* const value_ptr;  // Set to nullptr if not used.
+    token_type_t type;
+    token_subtype_t subtype;
+    std::basic_string_view<CharT> text;  // The code units the token spans.
+    token_value_t value;  // Tagged NO_VALUE if not used.
 };
 
+typedef BasicToken<char16_t> Token;
+typedef BasicToken<char> Utf8Token;
+
 #endif
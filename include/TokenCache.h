@@ -0,0 +1,79 @@
+#ifndef M6_TOKENCACHE_H
+#define M6_TOKENCACHE_H
+
+#include <TokenList.h>
+#include <atomic>
+#include <mutex>
+
+// Bump whenever the layout of a cache entry changes.
+#define TOKEN_CACHE_FORMAT_VERSION 2
+#define TOKEN_CACHE_MAGIC "M6TC"
+#define TOKEN_CACHE_EXTENSION ".m6c"
+#define TOKEN_CACHE_DEFAULT_SIZE ((uint64_t) 256 << 20u)
+// Temporary files older than this many seconds were left behind by a process that died while writing them.
+#define TOKEN_CACHE_STALE_TEMPORARY 3600
+
+typedef struct {
+    char magic[4];
+    uint32_t format_version;
+    uint32_t tokenizer_version;
+    uint32_t code_unit_size;
+    uint64_t content_size;  // In code units.
+    uint64_t content_hash;
+    uint64_t token_count;
+    uint64_t identifier_count;
+} token_cache_header_t;
+
+typedef struct {
+    uint32_t type;
+    uint16_t subtype;
+    uint16_t value_tag;  // The token_value_tag_t of the value.
+    uint64_t begin;  // In code units from the start of the content.
+    uint64_t end;
+    uint64_t value;  // The bits of the value, or the index of the identifier.
+} token_cache_record_t;
+
+/*
+ * A directory of tokenized files, keyed by a hash of their contents, the tokenizer version and the code unit size.
+ *
+ * An entry is the header, one record per token of the root, the length of every identifier, and then the code
+ * units of every identifier. A hit rebuilds the tokens over the content it was given, without lexing it.
+ *
+ * Entries are written to a temporary file and renamed into place, so that any number of threads and processes
+ * can share a directory without ever seeing half an entry. Hits refresh the modification time of their entry,
+ * and once the directory grows past its maximum size, the entries that were used the longest ago are removed
+ * until it is back under three quarters of it.
+ *
+ * The cache is only ever a shortcut: anything that goes wrong with an entry makes it a miss.
+ */
+template <typename CharT>
+class BasicTokenCache {
+public:
+    typedef BasicRootToken<CharT> root_t;
+
+    BasicTokenCache (const char* directory, uint64_t max_size);
+
+    [[nodiscard]] err_t open ();
+
+    std::optional<root_t> find (std::basic_string_view<CharT> content);
+
+    void store (std::basic_string_view<CharT> content, root_t& root);
+
+protected:
+    [[nodiscard]] std::string path_for (std::basic_string_view<CharT> content, uint64_t hash) const;
+
+    [[nodiscard]] static uint64_t hash_content (std::basic_string_view<CharT> content);
+
+    uint64_t scan (bool evict);
+
+    std::string directory;
+    uint64_t max_size;
+    std::atomic<uint64_t> size_estimate {0};  // What the directory is thought to hold, in bytes.
+    std::atomic<uint64_t> temporary_counter {0};
+    std::mutex eviction;
+};
+
+typedef BasicTokenCache<char16_t> TokenCache;
+typedef BasicTokenCache<char> Utf8TokenCache;
+
+#endif
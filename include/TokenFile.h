@@ -0,0 +1,109 @@
+#ifndef M6_TOKENFILE_H
+#define M6_TOKENFILE_H
+
+#include <TokenList.h>
+#include <SourceBuffer.h>
+#include <unordered_map>
+
+// Bump whenever the layout of a token file changes.
+#define TOKEN_FILE_FORMAT_VERSION 1
+#define TOKEN_FILE_MAGIC "M6TK"
+#define TOKEN_FILE_EXTENSION ".m6t"
+// Written as is, so that a file written on a machine of the other byte order reads back as something else.
+#define TOKEN_FILE_BYTE_ORDER ((uint32_t) 0x01'02'03'04)
+// Offsets are stored in 32 bits, so a token file holds at most this many code units of content.
+#define TOKEN_FILE_MAX_CONTENT_SIZE ((uint64_t) UINT32_MAX)
+
+// Record flags.
+#define TOKEN_FILE_HAS_VALUE ((uint16_t) 1u)
+
+typedef struct {
+    char magic[4];
+    uint32_t format_version;
+    uint32_t tokenizer_version;
+    uint32_t code_unit_size;
+    uint32_t byte_order;
+    uint32_t reserved;
+    uint64_t content_size;  // In code units.
+    uint64_t token_count;
+    uint64_t identifier_count;
+    uint64_t value_count;
+} token_file_header_t;
+
+typedef struct {
+    uint32_t type;
+    uint16_t subtype;
+    uint16_t flags;
+    uint32_t begin;  // In code units from the start of the content.
+    uint32_t end;
+    uint32_t value;  // The index of the identifier for identifiers, or of the value if TOKEN_FILE_HAS_VALUE is set.
+    uint32_t descendants;  // How many of the records right after this one are tokens nested in it.
+} token_file_record_t;
+
+typedef struct {
+    uint32_t begin;  // Where the identifier first shows up in the content.
+    uint32_t size;
+} token_file_identifier_t;
+
+/*
+ * A tokenized file, in a versioned binary format that other tools can read without lexing anything.
+ *
+ * A token file is the header, followed by one record per token, the identifier table, the value table, and the
+ * content itself (with a '\0' after it), in that order. Every section is a whole number of 8 byte words, and all
+ * of them are in the byte order of the machine that wrote the file.
+ *
+ * The tokens nested in the root are written depth first, each followed right away by the tokens nested in it, so
+ * the next sibling of record i is record i + 1 + descendants. Identifiers are interned: every occurrence of one
+ * refers to the same entry of the identifier table, which points at its text in the content. Values are the bits
+ * of the decoded literal or opcode (an int64_t, a double for FLOAT_N subtypes, a bool, or an opcode_t), and are
+ * interned as well, so the table of a typical file holds little more than the opcodes it uses.
+ *
+ * Loading a file maps it read-only, and checks every section and record once, without allocating anything per
+ * token. Records, identifiers and values are then read straight out of the mapping, once a load has succeeded.
+ */
+template <typename CharT>
+class BasicTokenFile {
+public:
+    typedef BasicToken<CharT> token_t;
+    typedef BasicRootToken<CharT> root_t;
+
+    [[nodiscard]] err_t load (const char* file_name);
+
+    [[nodiscard]] static std::string serialize (root_t& root);
+
+    [[nodiscard]] size_t size () const;
+
+    [[nodiscard]] const token_file_record_t& get_record (size_t index) const;
+
+    [[nodiscard]] size_t next_sibling (size_t index) const;
+
+    [[nodiscard]] std::basic_string_view<CharT> get_text (size_t index) const;
+
+    [[nodiscard]] std::basic_string_view<CharT> get_identifier (uint32_t identifier) const;
+
+    [[nodiscard]] uint64_t get_value (size_t index) const;
+
+    [[nodiscard]] std::basic_string_view<CharT> get_content () const;
+
+    [[nodiscard]] size_t get_identifier_count () const;
+
+protected:
+    static void serialize (const token_t& token, const CharT* content, std::vector<token_file_record_t>& records,
+                           std::vector<uint32_t>& identifier_indices,
+                           std::vector<token_file_identifier_t>& identifiers,
+                           std::unordered_map<uint64_t, uint32_t>& value_indices, std::vector<uint64_t>& values);
+
+    err_t validate ();
+
+    SourceBuffer buffer;
+    token_file_header_t header {};
+    const token_file_record_t* records = nullptr;
+    const token_file_identifier_t* identifiers = nullptr;
+    const uint64_t* values = nullptr;
+    const CharT* content = nullptr;
+};
+
+typedef BasicTokenFile<char16_t> TokenFile;
+typedef BasicTokenFile<char> Utf8TokenFile;
+
+#endif
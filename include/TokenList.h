@@ -0,0 +1,247 @@
+#ifndef M6_TOKENLIST_H
+#define M6_TOKENLIST_H
+
+#include <IdentifierTable.h>
+#include <LineIndex.h>
+#include <Token.h>
+#include <result.h>
+#include <iterator>
+#include <memory>
+
+#define TOKEN_VECTOR_RESERVE         0x00'04'00
+// Tokens are reserved for up front at one per this many code units of input, and for no more than TOKEN_RESERVE_MAX.
+// Every range, brackets and braces included, is a single token, so most files have far fewer. Long runs of short
+// statements at the top level have more (one per 2.3 units or so), and are left to reserve_for to make room for.
+#define CODE_UNITS_PER_TOKEN         8
+#define TOKEN_RESERVE_MAX            0x10'00'00
+
+/*
+ * Where the memory of a token tree goes, in bytes.
+ *
+ * The tokens, identifiers, strings and lines are what their tables hold. The source is the buffer that the tokens
+ * range over, when the root owns it. The slack is everything else the root holds on to: what was reserved but never
+ * used, what the arena has left in its last chunk, what a table outgrew (as arenas never free anything one
+ * allocation at a time), and the buffer strings are decoded to.
+ */
+struct memory_usage_t {
+    size_t tokens;
+    size_t identifiers;
+    size_t strings;
+    size_t lines;
+    size_t source;
+    size_t slack;
+
+    [[nodiscard]] size_t total () const {
+        return this->tokens + this->identifiers + this->strings + this->lines + this->source + this->slack;
+    }
+};
+
+/*
+ * The tokens of a root, stored as parallel columns (struct of arrays) rather than as an array of tokens.
+ *
+ * Each token takes a 32-bit type, a 16-bit subtype, a 32-bit offset from the base of the list, a 32-bit length, and
+ * its value as a tag and 64 bits, which is 23 bytes in all. Scans that only need some of the columns, like the regex
+ * lookbehind skipping over whitespace and comments, only touch those. Since offsets are 32-bit, a list can only
+ * range over the first 4 GiB code units of a buffer.
+ *
+ * Tokens are read and written as BasicToken values, which are built from (or split into) the columns on the spot,
+ * so a token read from the list is a copy, and writing to it does not change the list. Offsets are relative to the
+ * base, so moving the base moves every token with it. The list holds no pointers of its own, so it stays valid for
+ * as long as the buffer at its base does.
+ *
+ * Lists can be moved but not copied, so the columns are never copied by accident. Tokens are appended in place
+ * with emplace_back, without building a token first.
+ */
+template <typename CharT>
+class BasicTokenList {
+public:
+    typedef BasicToken<CharT> token_t;
+
+    // Random access over the tokens, which yields them by value.
+    class iterator {
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef token_t value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef void pointer;
+        typedef token_t reference;
+
+        iterator (const BasicTokenList* list, size_t index) : list(list), index(index) {}
+
+        token_t operator* () const { return (*this->list)[this->index]; }
+
+        token_t operator[] (difference_type n) const { return (*this->list)[this->index + n]; }
+
+        iterator& operator++ () { ++this->index; return *this; }
+
+        iterator& operator-- () { --this->index; return *this; }
+
+        iterator operator++ (int) { return iterator(this->list, this->index++); }
+
+        iterator operator-- (int) { return iterator(this->list, this->index--); }
+
+        iterator& operator+= (difference_type n) { this->index += n; return *this; }
+
+        iterator& operator-= (difference_type n) { this->index -= n; return *this; }
+
+        iterator operator+ (difference_type n) const { return iterator(this->list, this->index + n); }
+
+        iterator operator- (difference_type n) const { return iterator(this->list, this->index - n); }
+
+        difference_type operator- (const iterator& other) const {
+            return (difference_type) this->index - (difference_type) other.index;
+        }
+
+        bool operator== (const iterator& other) const { return this->index == other.index; }
+
+        bool operator!= (const iterator& other) const { return this->index != other.index; }
+
+        bool operator< (const iterator& other) const { return this->index < other.index; }
+
+    protected:
+        const BasicTokenList* list;
+        size_t index;
+    };
+
+    explicit BasicTokenList (const CharT* base = nullptr, Arena* arena = nullptr);
+
+    BasicTokenList (const BasicTokenList&) = delete;
+
+    BasicTokenList& operator= (const BasicTokenList&) = delete;
+
+    BasicTokenList (BasicTokenList&&) = default;
+
+    BasicTokenList& operator= (BasicTokenList&&) = default;
+
+    [[nodiscard]] size_t size () const;
+
+    [[nodiscard]] bool empty () const;
+
+    void reserve (size_t n);
+
+    void reserve_for (const CharT* end);
+
+    void clear ();
+
+    void push_back (const token_t& token);
+
+    void emplace_back (token_type_t type, token_subtype_t subtype,
+                       const CharT* begin, const CharT* end, token_value_t value);
+
+    void pop_back ();
+
+    [[nodiscard]] token_t operator[] (size_t index) const;
+
+    [[nodiscard]] token_t back () const;
+
+    [[nodiscard]] iterator begin () const;
+
+    [[nodiscard]] iterator end () const;
+
+    void set (size_t index, const token_t& token);
+
+    void insert (size_t position, const BasicTokenList& other, size_t first, size_t last);
+
+    void erase (size_t first, size_t last);
+
+    void shift (size_t first, size_t last, std::ptrdiff_t distance);
+
+    [[nodiscard]] const CharT* get_base () const;
+
+    void set_base (const CharT* base);
+
+    [[nodiscard]] token_type_t get_type (size_t index) const;
+
+    [[nodiscard]] token_subtype_t get_subtype (size_t index) const;
+
+    [[nodiscard]] uint32_t get_offset (size_t index) const;
+
+    [[nodiscard]] uint32_t get_length (size_t index) const;
+
+    [[nodiscard]] std::basic_string_view<CharT> get_text (size_t index) const;
+
+    [[nodiscard]] token_value_t get_value (size_t index) const;
+
+    void set_value (size_t index, token_value_t value);
+
+    [[nodiscard]] size_t get_size_in_bytes () const;
+
+protected:
+    void reserve_ahead (const CharT* lexed, size_t needed);
+
+    const CharT* base;
+    const CharT* expected_end = nullptr;  // Of the input that reserve_for made room for the tokens of, if any.
+    arena_vector<uint32_t> types;  // Every token type fits in 32 bits, see Token.h.
+    arena_vector<uint16_t> subtypes;  // So does every subtype, OPCODE_TO_SUBTYPE included.
+    arena_vector<uint32_t> offsets;  // In code units from the base.
+    arena_vector<uint32_t> lengths;
+    arena_vector<token_value_tag_t> tags;
+    arena_vector<uint64_t> values;  // The bits of each value.
+};
+
+/*
+ * A token that owns the tokens in it, along with the identifiers they refer to. The lexer appends the tokens it
+ * finds to its base token, which is always one of these, and tokenizing returns one of type ROOT.
+ *
+ * Every identifier in a root is interned into its identifier table (see IdentifierTable.h), and identifier
+ * tokens hold its id, so root.identifiers[token.get_identifier()] is the identifier a token refers to.
+ *
+ * String literals are only decoded when get_string asks for their value. A literal without escapes is its own
+ * value, and is handed out as it is. Any other is decoded once, and interned into the string table, so a string
+ * that shows up many times (like the keys of a large JSON-like file) is only held once.
+ *
+ * Lines and columns are only worked out once a position is asked for, which builds the line index of the root (see
+ * LineIndex.h) in a single pass over its text.
+ *
+ * The tokens and identifiers of a root are allocated from its arena (see Arena.h), which lives as long as the root
+ * does, or as long as any list or identifier table that was moved out of it.
+ *
+ * Tokens are offsets into the buffer the root was tokenized from. A root tokenized from a file holds on to the
+ * buffer the file was loaded into, so it can be kept after its tokenizer has gone on to other files. A root
+ * tokenized from a buffer of the caller's is only valid for as long as that buffer is.
+ *
+ * Roots can be moved but not copied, so tokenizing hands out the root it built rather than a copy of it.
+ */
+template <typename CharT>
+class BasicRootToken : public BasicToken<CharT> {
+public:
+    typedef typename BasicToken<CharT>::const_iterator const_iterator;
+
+    BasicRootToken (token_type_t type, token_subtype_t subtype,
+                    const_iterator begin, const_iterator end,
+                    token_value_t value, std::shared_ptr<Arena> arena = nullptr);
+
+    BasicRootToken (const BasicRootToken&) = delete;
+
+    BasicRootToken& operator= (const BasicRootToken&) = delete;
+
+    BasicRootToken (BasicRootToken&&) = default;
+
+    BasicRootToken& operator= (BasicRootToken&&) = default;
+
+    std::string colorized_output ();
+
+    Result<std::basic_string_view<CharT>> get_string (size_t index);
+
+    [[nodiscard]] text_position_t get_position (size_t index);
+
+    [[nodiscard]] text_position_t get_offset_position (size_t offset);
+
+    [[nodiscard]] memory_usage_t memory_usage () const;
+
+    std::shared_ptr<Arena> arena;  // First, so that it is destroyed after everything that was allocated from it.
+    std::shared_ptr<const void> source;  // Owns the buffer the tokens range over, unless the caller does.
+    BasicTokenList<CharT> token_vector;
+    BasicIdentifierTable<CharT> identifiers;
+    BasicIdentifierTable<CharT> strings;  // The values of the string literals with escapes that were asked for.
+    std::basic_string<CharT> decoded;  // Where a string literal is decoded to before it is interned.
+    BasicLineIndex<CharT> lines;  // Built the first time a position is asked for.
+};
+
+typedef BasicTokenList<char16_t> TokenList;
+typedef BasicTokenList<char> Utf8TokenList;
+
+typedef BasicRootToken<char16_t> RootToken;
+typedef BasicRootToken<char> Utf8RootToken;
+
+#endif
@@ -1,7 +1,7 @@
 #ifndef M6_TOKENTYPECHECKER_H
 #define M6_TOKENTYPECHECKER_H
 
-#include <Token.h>  // Includes <toplev.h> as well.
+#include <TokenList.h>  // Includes <Token.h> and <toplev.h> as well.
 
 // NO_INCREMENT is used to signal that the token iterator has reached the character after this token ended,
 // and does not need to be incremented to reach it.
@@ -11,33 +11,46 @@
 // then we specify NO_INCREMENT and put a comment elaborating further.
 #define NO_INCREMENT ;
 
-#define TOKEN_VECTOR_RESERVE         0x00'04'00
+// Token offsets are stored in 32 bits, so inputs longer than this many code units are turned away before lexing.
+#define MAX_INPUT_SIZE               ((uint64_t) UINT32_MAX)
+
+// How many code units past the end of a token the lexer may have looked at to decide on it.
+// The longest lookahead is the keyword check, which reads up to OP_KEYWORD_SIZE units from the token start.
+#define LEXER_LOOKAHEAD (OP_KEYWORD_SIZE + MAX_OPERATOR_SIZE)
 
 /* Defines an operator as an opcode_t opcode, while passing information about the uint8_t size
- * (length in characters) the operator is taking, so we can iterate past it.
+ * (length in characters) the operator is taking, so we can iterate past it, and the uint8_t entry
+ * (index in OPERATORS) that it was recognized as, so we can find the end of a range that it starts.
  */
 typedef struct {
     opcode_t opcode;
     uint8_t size;
+    uint8_t entry;
 } __attribute__((aligned(16))) operator_t;
 
+template <typename CharT>
 class TokenTypeChecker {
 public:
+    typedef BasicToken<CharT> token_t;
+    typedef BasicRootToken<CharT> root_t;
+
     explicit TokenTypeChecker (int log_handler (const char*, ...));
 
 protected:
     int (* log_handler) (const char*, ...);
 
-    Token* base_token;
-    std::u16string::const_iterator tokenizer_iterator;
+    root_t* base_token;
+    typename token_t::const_iterator tokenizer_iterator;
 
-    [[nodiscard]] operator_t process_symbol () const;
+    Result<operator_t> process_symbol () const;
 
     [[nodiscard]] bool next_token_is_number () const;
 
     [[nodiscard]] opcode_t next_token_is_keyword () const;
 
     [[nodiscard]] int64_t get_char_offset () const;
+
+    [[nodiscard]] typename token_t::const_iterator get_input_end () const;
 };
 
 #endif
@@ -2,22 +2,47 @@
 #define M6_TOKENIZER_H
 
 #include <LiteralProcessor.h>
+#include <SourceBuffer.h>
 
-class Tokenizer : public LiteralProcessor {
+// Bump whenever a change to the lexer can change the tokens it produces, so that cached tokens are not reused.
+#define TOKENIZER_VERSION 2
+
+template <typename CharT>
+class BasicTokenCache;
+
+template <typename CharT>
+class BasicTokenizer : public LiteralProcessor<CharT> {
 public:
-    explicit Tokenizer (int log_handler (const char*, ...));
+    using typename LiteralProcessor<CharT>::token_t;
+    using typename LiteralProcessor<CharT>::root_t;
+
+    explicit BasicTokenizer (int log_handler (const char*, ...));
+
+    Result<root_t> tokenize (const char* file_name);
 
-    Token tokenize (const char* file_name);
+    Result<root_t> tokenize (std::basic_string_view<CharT> str);
 
-    Token tokenize (const std::u16string& str);
+    Result<root_t> tokenize (const CharT* begin, const CharT* end);
 
-    Token tokenize (const std::u16string::const_iterator& begin, const std::u16string::const_iterator& end);
+    void set_cache (BasicTokenCache<CharT>* cache);
+
+    [[nodiscard]] memory_usage_t memory_usage () const;
 
 protected:
-    bool process_next_token ();
+    Result<std::basic_string_view<CharT>> load (const char* file_name, std::shared_ptr<const void>& owner);
+
+    Result<bool> process_next_token ();
+
+    std::shared_ptr<Arena> reuse_arena ();
 
-    std::u16string content;
+    std::shared_ptr<Arena> arena;  // The arena of the last root, which the next one reuses once that one is gone.
+    // The buffers the last file was loaded into, which the next file reuses once no root holds on to them.
+    std::shared_ptr<std::basic_string<CharT>> transcoded;  // Transcoded file contents, when the file needs transcoding.
+    std::shared_ptr<SourceBuffer> source;  // Raw file contents, when they can be lexed as they are.
+    BasicTokenCache<CharT>* cache = nullptr;  // Files are looked up in it before being lexed, if set.
 };
 
+typedef BasicTokenizer<char16_t> Tokenizer;
+typedef BasicTokenizer<char> Utf8Tokenizer;
 
 #endif
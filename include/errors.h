@@ -1,20 +1,42 @@
 #ifndef M6_ERRORS_H
 #define M6_ERRORS_H
 
+#include <cinttypes>
 
-#define ERR_COUNT 6
+// Errors are returned as err_t (see result.h), which is SUCCESS, that is 0, when nothing went wrong.
+typedef int64_t err_t;
+
+// Whether the library is built with exceptions. It works the same either way, since it only ever hands errors back,
+// except for the ones that fail raises.
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+#define M6_EXCEPTIONS
+#endif
+
+#define ERR_COUNT 16
 #define MAX_ERR_SIZE 200
 
-#define ERR_IFSTREAM_FAILED         1
-#define ERR_INVALID_ARGC            2
-#define ERR_TOKENIZING_SYNTAX_ERROR 3
-#define ERR_OPERATOR_INVALID_SIZE   4
-#define ERR_OPERATOR_INVALID_PUNC   5
-#define ERR_INVALID_START_OPERATOR  6
+#define ERR_IFSTREAM_FAILED         ((err_t) 1)
+#define ERR_INVALID_ARGC            ((err_t) 2)
+#define ERR_TOKENIZING_SYNTAX_ERROR ((err_t) 3)
+#define ERR_OPERATOR_INVALID_SIZE   ((err_t) 4)
+#define ERR_OPERATOR_INVALID_PUNC   ((err_t) 5)
+#define ERR_INVALID_START_OPERATOR  ((err_t) 6)
+#define ERR_INVALID_UTF8            ((err_t) 7)
+#define ERR_INVALID_UTF16           ((err_t) 8)
+#define ERR_UNEXPECTED_EXCEPTION    ((err_t) 9)
+#define ERR_INVALID_EDIT            ((err_t) 10)
+#define ERR_CACHE_UNAVAILABLE       ((err_t) 11)
+#define ERR_TOKEN_FILE_INVALID      ((err_t) 12)
+#define ERR_TOKEN_FILE_TOO_LARGE    ((err_t) 13)
+#define ERR_OFSTREAM_FAILED         ((err_t) 14)
+#define ERR_INPUT_TOO_LARGE         ((err_t) 15)
+#define ERR_INVALID_ESCAPE          ((err_t) 16)
 
 
 // TODO: https://github.com/mtsoltan/m6/issues/16
 extern const char errors[ERR_COUNT + 1][MAX_ERR_SIZE];
 
+[[noreturn]] void fail (err_t error);
+
 
 #endif
@@ -0,0 +1,14 @@
+#ifndef M6_HASH_H
+#define M6_HASH_H
+
+#include <toplev.h>
+
+/*
+ * A fast non-cryptographic 64-bit hash, for telling apart file contents that have most likely not changed.
+ *
+ * The input is folded 16 bytes at a time through a 64x64->128 bit multiply (in the style of wyhash), which runs
+ * at several bytes per cycle. It is not meant to hold up against inputs crafted to collide.
+ */
+uint64_t hash_bytes (const void* data, size_t size, uint64_t seed);
+
+#endif
@@ -5,6 +5,9 @@
 
 int null_io_handler (const char* a, ...);
 
+// Diagnostics that must not get mixed into output written to stdout go here.
+int stderr_io_handler (const char* format, ...);
+
 #ifdef USE_STDIO
 
 #include <cstdio>
@@ -4,6 +4,7 @@
 // TODO: https://github.com/mtsoltan/m6/issues/15
 
 #include <toplev.h>
+#include <array>
 
 #define MAX_OPERATOR_SIZE 4
 
@@ -221,29 +222,324 @@ enum opcode_enum_t : opcode_t {
     OPCODE_VOLATILE,
 };
 
-struct char_cmp {
-    bool operator() (const char16_t* a, const char16_t* b) const {
-        auto la = std::char_traits<char16_t>::length(a),
-             lb = std::char_traits<char16_t>::length(b);
-        if (la != lb) {
-            return la < lb;
+typedef struct {
+    std::u16string_view text;
+    opcode_t opcode;
+    std::u16string_view end = {};  // What ends the range that the operator starts, for those that start one.
+} operator_entry_t;
+
+inline constexpr operator_entry_t OPERATORS[] = {
+    {u"?",    OPCODE_QMARK},
+    {u":",    OPCODE_COLON},  // Used in trinary operators, cases, labels,
+    {u",",    OPCODE_COMMA},  // and object property declaration.
+    {u".",    OPCODE_DOT},
+    {u"=",    OPCODE_A},
+    {u">",    OPCODE_GT},
+    {u"<",    OPCODE_LT},
+    {u"+",    OPCODE_ADD},  // OPCODE_UADD
+    {u"-",    OPCODE_SUB},  // OPCODE_USUB
+    {u"*",    OPCODE_MUL},
+    {u"/",    OPCODE_DIV, u"/"},  // OPCODE_REGEX
+    {u"%",    OPCODE_REM},
+    {u"&",    OPCODE_ANDB},
+    {u"|",    OPCODE_ORB},
+    {u"^",    OPCODE_XORB},
+    {u"~",    OPCODE_NOTB},
+    {u"!",    OPCODE_NOTL},
+    {u"\"",   OPCODE_QDOUBLE, u"\""},
+    {u"'",    OPCODE_QSINGLE, u"'"},
+    {u"`",    OPCODE_QTICK, u"`"},
+    {u"(",    OPCODE_PARENTHESES1, u")"},  // Used in keyword blocks, function literals, grouping, and
+    {u")",    OPCODE_PARENTHESES2},  // function calls.
+    {u"[",    OPCODE_BRACKET1, u"]"},  // Used in array access, array literals, and array appending.
+    {u"]",    OPCODE_BRACKET2},
+    {u"{",    OPCODE_BRACES1, u"}"},  // Used in keyword blocks, label blocks, and object literals.
+    {u"}",    OPCODE_BRACES2},
+
+    {u"??",   OPCODE_NULLC},
+    {u"=>",   OPCODE_ARROW},
+    {u".?",   OPCODE_DOTQMARK},
+    {u"+=",   OPCODE_AADD},
+    {u"-=",   OPCODE_ASUB},
+    {u"*=",   OPCODE_AMUL},
+    {u"/=",   OPCODE_ADIV},
+    {u"%=",   OPCODE_AREM},
+    {u"&=",   OPCODE_AANDB},
+    {u"^=",   OPCODE_AXORB},
+    {u"|=",   OPCODE_AORB},
+    {u"==",   OPCODE_EQ},
+    {u"!=",   OPCODE_NE},
+    {u">=",   OPCODE_GTE},
+    {u"<=",   OPCODE_LTE},
+    {u"**",   OPCODE_PWR},
+    {u"++",   OPCODE_INC},
+    {u"--",   OPCODE_DEC},
+    {u"<<",   OPCODE_SHL},
+    {u">>",   OPCODE_SHR},
+    {u"&&",   OPCODE_ANDL},
+    {u"||",   OPCODE_ORL},
+    {u"/*",   OPCODE_COMMENT1, u"*/"},
+    {u"*/",   OPCODE_COMMENT2},
+    {u"//",   OPCODE_COMMENTL, u"\n"},  // Comments should end on carriage return too, but we'll ignore that for now.
+
+    {u"**=",  OPCODE_APWR},
+    {u"<<=",  OPCODE_ASHL},
+    {u">>=",  OPCODE_ASHR},
+    {u"...",  OPCODE_TRIPLEDOT},
+    {u"&&=",  OPCODE_AANDL},
+    {u"||=",  OPCODE_AORL},
+    {u"?\?=", OPCODE_ANULLC},
+    {u"===",  OPCODE_EQE},
+    {u"!==",  OPCODE_NEE},
+    {u">>>",  OPCODE_SHRU},
+
+    {u">>>=", OPCODE_ASHRU},
+};
+
+// Operators are recognized by a DFA that is the trie of OPERATORS: there is a state for every prefix of an operator,
+// with the empty prefix being state 0. Characters go through a column each, and those that are in no operator share
+// column 0, which has no transitions. Since no transition leads back to state 0, landing on it means that no operator
+// goes on with the character that was just read.
+#define OPERATOR_NO_ENTRY ((uint8_t) 0xff)
+
+/**
+ * @return Whether every operator is plain ASCII, no longer than MAX_OPERATOR_SIZE, and listed only once.
+ */
+constexpr bool operators_are_valid () {
+    for (size_t i = 0; i < std::size(OPERATORS); ++i) {
+        const auto text = OPERATORS[i].text;
+        if (text.empty() || text.size() > MAX_OPERATOR_SIZE) {
+            return false;
+        }
+
+        for (const char16_t c: text) {
+            if (c == 0 || c >= 0x80) {
+                return false;
+            }
+        }
+
+        for (size_t j = 0; j < i; ++j) {
+            if (OPERATORS[j].text == text) {
+                return false;
+            }
+        }
+    }
+
+    return std::size(OPERATORS) < OPERATOR_NO_ENTRY;
+}
+
+static_assert(operators_are_valid(), "OPERATORS cannot be made into a DFA.");
+
+/**
+ * @return How many columns the DFA needs: one for every character that is in an operator, and column 0.
+ */
+constexpr size_t count_operator_columns () {
+    bool used[0x80] = {};
+    size_t rv = 1;
+
+    for (const auto& op: OPERATORS) {
+        for (const char16_t c: op.text) {
+            if (!used[c]) {
+                used[c] = true;
+                ++rv;
+            }
+        }
+    }
+
+    return rv;
+}
+
+/**
+ * @return How many states the DFA needs: one for every prefix of an operator, and state 0.
+ */
+constexpr size_t count_operator_states () {
+    size_t rv = 1;
+
+    for (size_t i = 0; i < std::size(OPERATORS); ++i) {
+        const auto text = OPERATORS[i].text;
+        for (size_t size = 1; size <= text.size(); ++size) {
+            bool seen = false;
+            for (size_t j = 0; j < i && !seen; ++j) {
+                seen = OPERATORS[j].text.substr(0, size) == text.substr(0, size);
+            }
+            rv += !seen;
+        }
+    }
+
+    return rv;
+}
+
+inline constexpr size_t OPERATOR_COLUMN_COUNT = count_operator_columns();
+inline constexpr size_t OPERATOR_STATE_COUNT = count_operator_states();
+
+static_assert(OPERATOR_STATE_COUNT < 0x1'00, "The states of the operator DFA need to fit into a uint8_t.");
+
+typedef struct {
+    std::array<uint8_t, 0x80> columns;  // The column of every ASCII character.
+    std::array<std::array<uint8_t, OPERATOR_COLUMN_COUNT>, OPERATOR_STATE_COUNT> next;
+    std::array<uint8_t, OPERATOR_STATE_COUNT> accepts;  // The index in OPERATORS of what a state spells, if anything.
+} operator_dfa_t;
+
+/**
+ * Builds the trie of OPERATORS, adding states and columns in the order that OPERATORS first needs them.
+ * @return
+ */
+constexpr operator_dfa_t make_operator_dfa () {
+    operator_dfa_t rv = {};
+    for (auto& accept: rv.accepts) {
+        accept = OPERATOR_NO_ENTRY;
+    }
+
+    uint8_t column_count = 1, state_count = 1;
+    for (uint8_t i = 0; i < std::size(OPERATORS); ++i) {
+        uint8_t state = 0;
+        for (const char16_t c: OPERATORS[i].text) {
+            uint8_t& column = rv.columns[c];
+            if (column == 0) {
+                column = column_count++;
+            }
+
+            uint8_t& next = rv.next[state][column];
+            if (next == 0) {
+                next = state_count++;
+            }
+            state = next;
         }
-        return std::char_traits<char16_t>::compare(a, b, la) < 0;
+        rv.accepts[state] = i;
     }
+
+    return rv;
+}
+
+inline constexpr operator_dfa_t OPERATOR_DFA = make_operator_dfa();
+
+typedef struct {
+    std::u16string_view text;
+    opcode_t opcode;
+} keyword_t;
+
+inline constexpr keyword_t KEYWORDS[] = {
+    {u"break",        OPCODE_BREAK},
+    {u"case",         OPCODE_CASE},
+    {u"catch",        OPCODE_CATCH},
+    {u"class",        OPCODE_CLASS},
+    {u"const",        OPCODE_CONST},
+    {u"continue",     OPCODE_CONTINUE},
+    {u"debugger",     OPCODE_DEBUGGER},
+    {u"default",      OPCODE_DEFAULT},
+    {u"delete",       OPCODE_DELETE},
+    {u"do",           OPCODE_DO},
+    {u"else",         OPCODE_ELSE},
+    {u"export",       OPCODE_EXPORT},
+    {u"extends",      OPCODE_EXTENDS},
+    {u"finally",      OPCODE_FINALLY},
+    {u"for",          OPCODE_FOR},
+    {u"function",     OPCODE_FUNCTION},
+    {u"if",           OPCODE_IF},
+    {u"import",       OPCODE_IMPORT},
+    {u"in",           OPCODE_IN},
+    {u"of",           OPCODE_OF},
+    {u"instanceof",   OPCODE_INSTANCEOF},
+    {u"new",          OPCODE_NEW},
+    {u"return",       OPCODE_RETURN},
+    {u"super",        OPCODE_SUPER},
+    {u"switch",       OPCODE_SWITCH},
+    {u"this",         OPCODE_THIS},
+    {u"throw",        OPCODE_THROW},
+    {u"try",          OPCODE_TRY},
+    {u"typeof",       OPCODE_TYPEOF},
+    {u"var",          OPCODE_VAR},
+    {u"void",         OPCODE_VOID},
+    {u"while",        OPCODE_WHILE},
+    {u"with",         OPCODE_WITH},
+    {u"yield",        OPCODE_YIELD},
+
+    {u"enum",         OPCODE_ENUM},
+
+    {u"implements",   OPCODE_IMPLEMENTS},
+    {u"interface",    OPCODE_INTERFACE},
+    {u"let",          OPCODE_LET},
+    {u"package",      OPCODE_PACKAGE},
+    {u"private",      OPCODE_PRIVATE},
+    {u"protected",    OPCODE_PROTECTED},
+    {u"public",       OPCODE_PUBLIC},
+    {u"static",       OPCODE_STATIC},
+
+    {u"await",        OPCODE_AWAIT},
+
+    {u"abstract",     OPCODE_ABSTRACT},
+    {u"boolean",      OPCODE_BOOLEAN},
+    {u"byte",         OPCODE_BYTE},
+    {u"char",         OPCODE_CHAR},
+    {u"double",       OPCODE_DOUBLE},
+    {u"final",        OPCODE_FINAL},
+    {u"float",        OPCODE_FLOAT},
+    {u"goto",         OPCODE_GOTO},
+    {u"int",          OPCODE_INT},
+    {u"long",         OPCODE_LONG},
+    {u"native",       OPCODE_NATIVE},
+    {u"short",        OPCODE_SHORT},
+    {u"synchronized", OPCODE_SYNCHRONIZED},
+    {u"throws",       OPCODE_THROWS},
+    {u"transient",    OPCODE_TRANSIENT},
+    {u"volatile",     OPCODE_VOLATILE},
+
+    {u"null",         OPCODE_NULL},
+    {u"true",         OPCODE_TRUE},
+    {u"false",        OPCODE_FALSE},
 };
 
-typedef std::map<opcode_t, const char16_t*> opcode_cstr_map;
-typedef std::map<const char16_t*, opcode_t, char_cmp> cstr_opcode_map;
-typedef std::map<const char16_t*, const char16_t*, char_cmp> cstr_cstr_map;
+// Keywords are looked up through a perfect hash of their size and their first, second and last characters, which
+// was picked so that no two keywords share a slot. The slots hold indices into KEYWORDS.
+#define KEYWORD_SLOT_COUNT  0x01'00
+#define KEYWORD_NO_SLOT     ((uint8_t) 0xff)
+#define KEYWORD_MIN_SIZE    2  // The hash reads the second character, so every keyword needs to have one.
+
+constexpr size_t keyword_hash (const char16_t first, const char16_t second, const char16_t last, const size_t size) {
+    return (first + second * 17u + last * 22u + size) & (KEYWORD_SLOT_COUNT - 1u);
+}
+
+/**
+ * @return Whether every keyword can be hashed, and hashes to a slot of its own.
+ */
+constexpr bool keywords_hash_apart () {
+    bool taken[KEYWORD_SLOT_COUNT] = {};
+
+    for (const auto& keyword: KEYWORDS) {
+        if (keyword.text.size() < KEYWORD_MIN_SIZE || keyword.text.size() >= OP_KEYWORD_SIZE) {
+            return false;
+        }
+
+        const size_t slot = keyword_hash(keyword.text[0], keyword.text[1], keyword.text.back(), keyword.text.size());
+        if (taken[slot]) {
+            return false;
+        }
+        taken[slot] = true;
+    }
+
+    return true;
+}
 
-const opcode_cstr_map& get_op_opcode_cstr_map (uint8_t operator_size = 0);
+static_assert(keywords_hash_apart(), "Two keywords hash to the same slot, so keyword_hash needs to change.");
 
-const cstr_opcode_map& get_op_cstr_opcode_map (uint8_t operator_size = 0);
+/**
+ * Puts the index of every keyword in KEYWORDS into the slot that it hashes to.
+ * @return
+ */
+constexpr std::array<uint8_t, KEYWORD_SLOT_COUNT> make_keyword_slots () {
+    std::array<uint8_t, KEYWORD_SLOT_COUNT> rv = {};
+    for (auto& slot: rv) {
+        slot = KEYWORD_NO_SLOT;
+    }
 
-const opcode_cstr_map& get_kw_opcode_cstr_map ();
+    for (uint8_t i = 0; i < std::size(KEYWORDS); ++i) {
+        const auto text = KEYWORDS[i].text;
+        rv[keyword_hash(text[0], text[1], text.back(), text.size())] = i;
+    }
 
-const cstr_opcode_map& get_kw_cstr_opcode_map ();
+    return rv;
+}
 
-const cstr_cstr_map& get_begin_end_map ();
+inline constexpr std::array<uint8_t, KEYWORD_SLOT_COUNT> KEYWORD_SLOTS = make_keyword_slots();
 
 #endif
@@ -0,0 +1,56 @@
+#ifndef M6_RESULT_H
+#define M6_RESULT_H
+
+#include <toplev.h>
+#include <utility>
+
+/* The error that a function fails with. It converts to a Result of any type, so failing reads the same everywhere:
+ * return failure_t {ERR_X};
+ */
+typedef struct {
+    err_t error;
+} failure_t;
+
+/*
+ * Either the value that a function made, or the error that kept it from making one.
+ *
+ * The lexer runs into errors in ordinary use (a syntax error is as likely an outcome as a token), so it hands them
+ * back rather than unwinding, which also keeps the library working when built with -fno-exceptions. Functions that
+ * have nothing to return other than whether they failed return a plain err_t instead.
+ */
+template <typename T>
+class [[nodiscard]] Result {
+public:
+    // Not explicit, so that a function can return its value as it is.
+    Result (const T& value) : value(value) {}
+
+    Result (T&& value) : value(std::move(value)) {}
+
+    Result (const failure_t failure) : error(failure.error) {}
+
+    [[nodiscard]] bool ok () const { return this->error == SUCCESS; }
+
+    explicit operator bool () const { return this->ok(); }
+
+    /**
+     * @return SUCCESS, or the error that the function failed with.
+     */
+    [[nodiscard]] err_t get_error () const { return this->error; }
+
+    /**
+     * @return The value, which only a Result that is ok() has.
+     */
+    [[nodiscard]] T& get_value () { return *this->value; }
+
+    [[nodiscard]] const T& get_value () const { return *this->value; }
+
+    T& operator* () { return *this->value; }
+
+    T* operator-> () { return &*this->value; }
+
+protected:
+    std::optional<T> value;
+    err_t error = SUCCESS;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef M6_SCAN_H
+#define M6_SCAN_H
+
+#include <Token.h>
+
+// Scanners that find where a run of code units of one class ends. Every scanner stops at end, or at the first code
+// unit that is not in the run, whichever comes first. Like the rest of the lexer, they need the code unit at end to
+// be readable and to be in no class, which the '\0' there is.
+//
+// The first SCAN_INLINE_UNITS code units are looked at one at a time, inline, since most runs (a single space, a
+// short name) end before a block is worth loading. Longer runs go on a block at a time: 32 bytes with AVX2, and 16
+// bytes otherwise (SSE2 or NEON), so a step covers 16 to 32 UTF-8 code units, or 8 to 16 UTF-16 ones. The blocks
+// are written with the vector extensions of GCC and Clang, which compile to whichever of those the target has.
+// Other compilers go on one code unit at a time.
+#define SCAN_INLINE_UNITS 8
+
+template <typename CharT>
+const CharT* skip_whitespace_blocks (const CharT* begin, const CharT* end);
+
+template <typename CharT>
+const CharT* skip_identifier_part_blocks (const CharT* begin, const CharT* end);
+
+/**
+ * @param begin
+ * @param end
+ * @return The end of the run of whitespace (see WHITESPACE_CHARACTERS) at begin.
+ */
+template <typename CharT>
+inline const CharT* skip_whitespace (const CharT* begin, const CharT* const end) {
+    for (size_t i = 0; i < SCAN_INLINE_UNITS; ++i, ++begin) {
+        if (!BasicToken<CharT>::is_whitespace(*begin)) {
+            return begin;
+        }
+    }
+
+    return skip_whitespace_blocks(begin, end);
+}
+
+/**
+ * @param begin
+ * @param end
+ * @return The end of the run of identifier characters and digits at begin.
+ */
+template <typename CharT>
+inline const CharT* skip_identifier_part (const CharT* begin, const CharT* const end) {
+    for (size_t i = 0; i < SCAN_INLINE_UNITS; ++i, ++begin) {
+        if (!BasicToken<CharT>::is_in_class(*begin, CHAR_IDENTIFIER | CHAR_DIGIT)) {
+            return begin;
+        }
+    }
+
+    return skip_identifier_part_blocks(begin, end);
+}
+
+#endif
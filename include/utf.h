@@ -0,0 +1,53 @@
+#ifndef M6_UTF_H
+#define M6_UTF_H
+
+#include <toplev.h>
+
+/*
+ * Validating UTF-8 <-> UTF-16 transcoders.
+ *
+ * Runs of ASCII are converted 16 or 32 code units at a time (SSE2 or AVX2, picked at runtime, with a scalar
+ * fallback on other targets). Setting M6_DISABLE_AVX2 in the environment keeps to SSE2. Everything else goes
+ * through a strict scalar decoder that rejects overlong forms, encoded surrogates, code points past U+10FFFF and
+ * truncated sequences.
+ *
+ * Both functions return NOT_FOUND on success. On failure they return the offset (in source code units) of the
+ * first invalid sequence, and result holds everything that was converted before it.
+ */
+int64_t utf8_to_utf16 (const char* begin, const char* end, std::u16string& result);
+
+int64_t utf16_to_utf8 (const char16_t* begin, const char16_t* end, std::string& result);
+
+/*
+ * Appends a single code point (up to U+10FFFF) to a string. Lone surrogates are encoded as they are, which is not
+ * valid UTF-8 or UTF-16, but is what a JavaScript string can hold.
+ */
+void append_code_point (char32_t code_point, std::u16string& result);
+
+void append_code_point (char32_t code_point, std::string& result);
+
+[[nodiscard]] inline err_t fromUTF8 (const char* begin, const char* end, std::u16string& result) {
+    return utf8_to_utf16(begin, end, result) == NOT_FOUND ? SUCCESS : ERR_INVALID_UTF8;
+}
+
+[[nodiscard]] inline err_t fromUTF8 (const std::string& source, std::u16string& result) {
+    return fromUTF8(source.data(), source.data() + source.size(), result);
+}
+
+// The source has to be valid UTF-16, which everything that was lexed from transcoded UTF-8 is.
+inline std::string toUTF8 (const std::u16string& source) {
+    std::string result;
+
+    if (utf16_to_utf8(source.data(), source.data() + source.size(), result) != NOT_FOUND) {
+        fail(ERR_INVALID_UTF16);
+    }
+
+    return result;
+}
+
+// UTF-8 to UTF-8 is the identity, so text that was lexed as UTF-8 does not need to get transcoded back.
+inline std::string toUTF8 (const std::string& source) {
+    return source;
+}
+
+#endif
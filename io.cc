@@ -1,3 +1,15 @@
+#include <io.h>
+#include <cstdarg>
+#include <cstdio>
+
 int null_io_handler (const char* a, ...) {
     return 0;
 }
+
+int stderr_io_handler (const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int rv = std::vfprintf(stderr, format, args);
+    va_end(args);
+    return rv;
+}
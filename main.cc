@@ -1,23 +1,294 @@
-#include <Tokenizer.h>
+#include <BatchTokenizer.h>
+#include <ParallelTokenizer.h>
+#include <StreamTokenizer.h>
+#include <TokenCache.h>
+#include <TokenFile.h>
 #include <iostream>  // Specified here because nothing else should need it, so it's not toplev.
+#include <unistd.h>
 
-// TODO: https://github.com/mtsoltan/m6/issues/14
-// TODO: https://github.com/mtsoltan/m6/issues/17
-int main (int argc, const char** argv) {
-    LTS_
+// Reads from stdin return whatever is available, up to this many bytes.
+#define STDIN_CHUNK_SIZE 0x01'00'00
 
-            if (argc > 2) {
-                throw ERR_INVALID_ARGC;
-            }
+// The file name that stands for stdin.
+#define STDIN_FILE_NAME "-"
+
+static void report_error (const std::string& file_name, const err_t error) {
+    std::fprintf(stderr, "%s: ", file_name.c_str());
+    std::fprintf(stderr, errors[error], file_name.c_str());
+    std::fputc('\n', stderr);
+}
+
+/**
+ * Writes where the memory of a file (or of whatever else is named) went to stderr, in bytes.
+ */
+static void report_memory (const std::string& name, const memory_usage_t& memory) {
+    std::fprintf(stderr, "%s: %zu bytes (tokens %zu, identifiers %zu, strings %zu, lines %zu, source %zu, slack %zu)\n",
+                 name.c_str(), memory.total(), memory.tokens, memory.identifiers, memory.strings, memory.lines,
+                 memory.source, memory.slack);
+}
+
+/**
+ * Writes the output of a file, either to stdout, or as a token file next to it.
+ * @return SUCCESS, or ERR_OFSTREAM_FAILED if the token file could not be written.
+ */
+static err_t emit (const std::string& file_name, const std::string& output, const bool binary) {
+    if (!binary) {
+        std::cout << output;
+        return SUCCESS;
+    }
+
+    std::ofstream file(file_name + TOKEN_FILE_EXTENSION, std::ios::binary | std::ios::trunc);
+    if (!file.write(output.data(), (std::streamsize) output.size()) || !file.flush()) {
+        return ERR_OFSTREAM_FAILED;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * Renders the output of a file, either as highlighted text or as a token file.
+ */
+template <typename CharT>
+static std::string render (BasicRootToken<CharT>& root, const bool binary) {
+    return binary ? BasicTokenFile<CharT>::serialize(root) : root.colorized_output();
+}
+
+/**
+ * Tokenizes every file on a pool of jobs workers, and writes their output in the order they were given.
+ * Files that fail are reported on stderr, and do not stop the others.
+ * @return The number of files that failed.
+ */
+template <typename CharT>
+static size_t run_batch (const std::vector<std::string>& file_names, const size_t jobs, const bool binary,
+                         const bool mem_report, BasicTokenCache<CharT>* cache) {
+    auto batch = BasicBatchTokenizer<CharT>(stderr_io_handler, jobs);
+    batch.set_cache(cache);
+    size_t failures = 0;
+
+    failures += batch.run(
+            file_names,
+            [binary] (BasicRootToken<CharT>& root) {
+                return render(root, binary);
+            },
+            [binary, mem_report, &failures] (const std::string& file_name, const std::string& output,
+                                             const err_t error, const memory_usage_t& memory) {
+                if (error != SUCCESS) {
+                    report_error(file_name, error);
+                    return;
+                }
+                if (mem_report) {
+                    report_memory(file_name, memory);
+                }
+                if (err_t e = emit(file_name, output, binary)) {
+                    report_error(file_name, e);
+                    ++failures;
+                }
+            });
+
+    return failures;
+}
+
+/**
+ * Tokenizes the files one at a time, splitting each of them between jobs threads, and writes their output.
+ * Files that fail are reported on stderr, and do not stop the others.
+ * @return The number of files that failed.
+ */
+template <typename CharT>
+static size_t run_parallel (const std::vector<std::string>& file_names, const size_t jobs, const bool binary,
+                            const bool mem_report, BasicTokenCache<CharT>* cache) {
+    auto tokenizer = BasicParallelTokenizer<CharT>(stderr_io_handler, jobs);
+    tokenizer.set_cache(cache);
+    size_t failures = 0;
+
+    for (const auto& file_name: file_names) {
+        Result<BasicRootToken<CharT>> root = tokenizer.tokenize(file_name.c_str());
+        err_t error = root ? emit(file_name, render(*root, binary), binary) : root.get_error();
+        if (error != SUCCESS) {
+            report_error(file_name, error);
+            ++failures;
+            continue;
+        }
+        if (mem_report) {
+            report_memory(file_name, root->memory_usage());
+        }
+    }
+
+    if (mem_report) {
+        report_memory("(tokenizer)", tokenizer.memory_usage());
+    }
+
+    return failures;
+}
 
-            const char* file_name = argv[1];
+/**
+ * Tokenizes stdin as it arrives, and writes the highlighted output of every statement to stdout as soon as the
+ * chunk that ends it has been read, rather than once all of stdin has been.
+ * @return The number of inputs that failed, which is 0 or 1.
+ */
+template <typename CharT>
+static size_t run_stdin () {
+    std::string output;
+    size_t statements_end = 0;  // Everything in output up to here is a complete statement.
 
-            auto tokenizer = Tokenizer(_L);
+    auto tokenizer = BasicStreamTokenizer<CharT>(stderr_io_handler, [&] (BasicToken<CharT>& token) {
+        output += token.to_string();
+        if (token.get_type() == EOL || token.get_type() == EOS) {
+            statements_end = output.size();
+        }
+    });
 
-            auto result = tokenizer.tokenize(file_name);
+    err_t error = SUCCESS;
+    char chunk[STDIN_CHUNK_SIZE];
+    while (true) {
+        ssize_t n = read(STDIN_FILENO, chunk, sizeof(chunk));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            error = ERR_IFSTREAM_FAILED;
+            break;
+        }
+        if (n == 0) {
+            error = tokenizer.finish();
+            break;
+        }
 
-            std::cout << result.colorized_output();
+        if ((error = tokenizer.feed_utf8(chunk, n)) != SUCCESS) {
+            break;
+        }
 
-    _LTS
+        // Written once per chunk, so that a large input piped in all at once is not written a line at a time.
+        if (statements_end != 0) {
+            std::cout.write(output.data(), (std::streamsize) statements_end).flush();
+            output.erase(0, statements_end);
+            statements_end = 0;
+        }
+    }
+
+    if (error != SUCCESS) {
+        report_error(STDIN_FILE_NAME, error);
+        return 1;
+    }
+
+    std::cout << output << std::flush;
     return 0;
 }
+
+/**
+ * Opens the cache (if there is a directory for it) and tokenizes every file one way or the other.
+ * @return The number of files that failed, or ERR_CACHE_UNAVAILABLE, in which case no file was tokenized.
+ */
+template <typename CharT>
+static Result<size_t> run (const std::vector<std::string>& file_names, const size_t jobs, const bool parallel,
+                           const bool binary, const bool mem_report, const char* cache_directory,
+                           const uint64_t cache_size) {
+    std::optional<BasicTokenCache<CharT>> cache;
+    if (cache_directory != nullptr) {
+        cache.emplace(cache_directory, cache_size);
+        if (err_t error = cache->open()) {
+            return failure_t {error};
+        }
+    }
+
+    auto cache_ptr = cache.has_value() ? &*cache : nullptr;
+    return parallel ? run_parallel<CharT>(file_names, jobs, binary, mem_report, cache_ptr)
+                    : run_batch<CharT>(file_names, jobs, binary, mem_report, cache_ptr);
+}
+
+/**
+ * Reads the arguments, and runs whatever they ask for.
+ * @param argc
+ * @param argv
+ * @param failures Set to the number of files that failed.
+ * @return SUCCESS, or the error that kept anything from running, such as invalid arguments.
+ */
+static err_t run_arguments (int argc, const char** argv, size_t& failures) {
+    // --utf8 lexes files as raw UTF-8 bytes instead of transcoding them to UTF-16 first.
+    // -j N sets the number of worker threads, which defaults to the number of cores.
+    // --parallel splits every file between the worker threads, instead of giving each file to one of them.
+    // --cache DIR looks files up in a token cache in DIR before lexing them, and adds them to it after.
+    // --cache-size BYTES bounds how large the cache may grow before old entries are evicted.
+    // --binary writes every FILE out as a token file, FILE.m6t, instead of highlighting it to stdout.
+    // --mem-report writes how many bytes the tokens of every FILE took to stderr, broken down by what for.
+    // --files-from LIST reads file names from LIST, one per line, in addition to the ones given as arguments.
+    // A FILE of - reads stdin instead, and writes out every statement as soon as it has been read.
+    bool utf8 = false;
+    bool parallel = false;
+    bool binary = false;
+    bool mem_report = false;
+    size_t jobs = 0;
+    const char* cache_directory = nullptr;
+    uint64_t cache_size = TOKEN_CACHE_DEFAULT_SIZE;
+    std::vector<std::string> file_names;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--utf8") == 0) {
+            utf8 = true;
+        } else if (std::strcmp(argv[i], "--parallel") == 0) {
+            parallel = true;
+        } else if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            jobs = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            cache_directory = argv[++i];
+        } else if (std::strcmp(argv[i], "--cache-size") == 0 && i + 1 < argc) {
+            cache_size = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--binary") == 0) {
+            binary = true;
+        } else if (std::strcmp(argv[i], "--mem-report") == 0) {
+            mem_report = true;
+        } else if (std::strcmp(argv[i], "--files-from") == 0 && i + 1 < argc) {
+            std::ifstream list(argv[++i]);
+            if (list.fail()) {
+                return ERR_IFSTREAM_FAILED;
+            }
+            for (std::string line; std::getline(list, line);) {
+                if (!line.empty()) {
+                    file_names.push_back(line);
+                }
+            }
+        } else {
+            file_names.emplace_back(argv[i]);
+        }
+    }
+
+    if (file_names.empty()) {
+        return ERR_INVALID_ARGC;
+    }
+
+    // stdin is streamed rather than loaded, so it has to be the only input, and has no token file to go to.
+    bool from_stdin = std::find(file_names.begin(), file_names.end(), STDIN_FILE_NAME) != file_names.end();
+    if (from_stdin && (file_names.size() > 1 || binary)) {
+        return ERR_INVALID_ARGC;
+    }
+
+    if (from_stdin) {
+        failures = utf8 ? run_stdin<char>() : run_stdin<char16_t>();
+        return SUCCESS;
+    }
+
+    Result<size_t> rv = utf8 ? run<char>(file_names, jobs, parallel, binary, mem_report, cache_directory, cache_size)
+                             : run<char16_t>(file_names, jobs, parallel, binary, mem_report, cache_directory,
+                                             cache_size);
+    if (!rv) {
+        return rv.get_error();
+    }
+
+    failures = *rv;
+    return SUCCESS;
+}
+
+// TODO: https://github.com/mtsoltan/m6/issues/14
+// TODO: https://github.com/mtsoltan/m6/issues/17
+int main (int argc, const char** argv) {
+    size_t failures = 0;
+
+    if (err_t error = run_arguments(argc, argv, failures)) {
+#ifdef LOG_ERRORS
+        _L("%s\n", errors[error]);
+        _X();
+#endif
+        return 1;
+    }
+
+    return failures ? 1 : 0;
+}
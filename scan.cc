@@ -0,0 +1,98 @@
+#include <scan.h>
+#include <cstring>
+
+#if defined(__GNUC__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define SCAN_VECTOR
+#ifdef __AVX2__
+#define SCAN_BLOCK_SIZE 32
+#else
+#define SCAN_BLOCK_SIZE 16
+#endif
+
+typedef uint8_t scan_u8_t __attribute__((vector_size(SCAN_BLOCK_SIZE)));
+typedef uint16_t scan_u16_t __attribute__((vector_size(SCAN_BLOCK_SIZE)));
+
+// A block of code units, as unsigned lanes.
+template <typename CharT>
+using scan_block_t = std::conditional_t<sizeof(CharT) == 1, scan_u8_t, scan_u16_t>;
+#endif
+
+// The classes spelled out as comparisons, which work on a single unsigned code unit as well as on a block of them,
+// lane by lane. Code units past ASCII are in neither, like in CHARACTER_CLASSES.
+
+template <typename T>
+static constexpr auto whitespace_units (const T c) {
+    return (c == ' ') | (((T) (c - '\t') < 5) & (c != '\n'));
+}
+
+template <typename T>
+static constexpr auto identifier_part_units (const T c) {
+    return ((T) ((c | 0x20u) - 'a') < 26) | ((T) (c - '0') < 10) | (c == '_') | (c == '$');
+}
+
+// Both have to agree with the class table, which the code units after the last block are looked up in.
+static constexpr bool matches_classes () {
+    for (uint32_t c = 0; c < 0x1'00; ++c) {
+        const char_class_t classes = c < CHARACTER_CLASSES.size() ? CHARACTER_CLASSES[c] : 0;
+        if ((bool) whitespace_units(c) != (bool) (classes & CHAR_WHITESPACE) ||
+            (bool) identifier_part_units(c) != (bool) (classes & (CHAR_IDENTIFIER | CHAR_DIGIT))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(matches_classes(), "The scanners do not match CHARACTER_CLASSES.");
+
+/**
+ * Finds where a run of code units in classes ends, a block at a time, and then one code unit at a time over
+ * whatever is left.
+ * @param begin
+ * @param end
+ * @param classes
+ * @param units Tells which code units of a block are in classes.
+ * @return The first code unit from begin that is not in classes, or end.
+ */
+template <typename CharT, typename UnitsT>
+static const CharT* skip_run (const CharT* begin, const CharT* const end, const char_class_t classes, UnitsT units) {
+#ifdef SCAN_VECTOR
+    constexpr size_t block_units = SCAN_BLOCK_SIZE / sizeof(CharT);
+
+    for (; (size_t) (end - begin) >= block_units; begin += block_units) {
+        scan_block_t<CharT> block;
+        std::memcpy(&block, begin, SCAN_BLOCK_SIZE);
+
+        // All ones in every lane that is not in the run.
+        const auto outside = ~units(block);
+        uint64_t words[SCAN_BLOCK_SIZE / 8];
+        std::memcpy(words, &outside, SCAN_BLOCK_SIZE);
+
+        for (size_t i = 0; i < SCAN_BLOCK_SIZE / 8; ++i) {
+            if (words[i] != 0) {
+                return begin + (i * 8 + __builtin_ctzll(words[i]) / 8) / sizeof(CharT);
+            }
+        }
+    }
+#endif
+
+    for (; begin != end && BasicToken<CharT>::is_in_class(*begin, classes); ++begin);
+
+    return begin;
+}
+
+template <typename CharT>
+const CharT* skip_whitespace_blocks (const CharT* const begin, const CharT* const end) {
+    return skip_run(begin, end, CHAR_WHITESPACE, [] (const auto c) { return whitespace_units(c); });
+}
+
+template <typename CharT>
+const CharT* skip_identifier_part_blocks (const CharT* const begin, const CharT* const end) {
+    return skip_run(begin, end, CHAR_IDENTIFIER | CHAR_DIGIT,
+                    [] (const auto c) { return identifier_part_units(c); });
+}
+
+template const char16_t* skip_whitespace_blocks (const char16_t* begin, const char16_t* end);
+template const char* skip_whitespace_blocks (const char* begin, const char* end);
+
+template const char16_t* skip_identifier_part_blocks (const char16_t* begin, const char16_t* end);
+template const char* skip_identifier_part_blocks (const char* begin, const char* end);
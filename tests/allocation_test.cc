@@ -0,0 +1,167 @@
+#include <Tokenizer.h>
+#include "check.h"
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+
+// Every allocation the program makes goes through here, the arena's chunks included, so a test can count the ones
+// that something makes.
+static size_t allocations = 0;
+
+void* operator new (size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size != 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete (void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete (void* p, size_t) noexcept {
+    std::free(p);
+}
+
+template <typename CharT>
+static std::basic_string<CharT> repeat (const std::basic_string<CharT>& str, size_t n) {
+    std::basic_string<CharT> rv;
+    for (size_t i = 0; i < n; ++i) {
+        rv += str;
+    }
+    return rv;
+}
+
+/**
+ * Tokenizes a source, and counts what that allocates.
+ * @param source
+ * @param token_count Where the number of tokens goes.
+ * @return The number of allocations, or SIZE_MAX if the source did not tokenize.
+ */
+template <typename CharT>
+static size_t count_allocations (const std::basic_string<CharT>& source, size_t& token_count) {
+    BasicTokenizer<CharT> tokenizer(null_io_handler);
+
+    const size_t before = allocations;
+    Result<BasicRootToken<CharT>> root = tokenizer.tokenize(source);
+    const size_t rv = allocations - before;
+
+    CHECK(root.ok());
+    if (!root) {
+        return SIZE_MAX;
+    }
+    token_count = root->token_vector.size();
+    return rv;
+}
+
+/**
+ * Checks that a root only makes room for identifiers once it has one, and that tokens are not allocated one by one.
+ */
+template <typename CharT>
+static void test_allocations (const std::basic_string<CharT>& statement, const std::basic_string<CharT>& literals) {
+    BasicTokenizer<CharT> tokenizer(null_io_handler);
+
+    // Neither an empty table, nor a root without identifiers, has anything allocated for them.
+    size_t before = allocations;
+    BasicIdentifierTable<CharT> table;
+    CHECK(allocations == before);
+    CHECK(table.get_size_in_bytes() == 0);
+
+    Result<BasicRootToken<CharT>> root = tokenizer.tokenize(literals);
+    CHECK(root.ok());
+    if (root) {
+        CHECK(root->identifiers.empty());
+        CHECK(root->memory_usage().identifiers == 0);
+    }
+
+    root = tokenizer.tokenize(statement);
+    CHECK(root.ok());
+    if (root) {
+        CHECK(!root->identifiers.empty());
+        CHECK(root->memory_usage().identifiers != 0);
+    }
+
+    // Tokens are appended to columns that grow geometrically, so ten times as many tokens only take a handful more
+    // allocations, rather than one or more each.
+    for (const auto& source: {statement, literals}) {
+        size_t small_count = 0, large_count = 0;
+        const size_t small = count_allocations(repeat(source, 1'000), small_count);
+        const size_t large = count_allocations(repeat(source, 10'000), large_count);
+        CHECK(large_count == small_count * 10);
+        CHECK(large <= small + 32);
+    }
+}
+
+/**
+ * Checks that what a root holds on to past its tokens stays in proportion to them, both for an input with far fewer
+ * tokens than code units, which a reserve by input size makes too much room for, and for one with a token per code
+ * unit, which outgrows it.
+ */
+template <typename CharT>
+static void test_reserve (const std::basic_string<CharT>& sparse, const std::basic_string<CharT>& dense) {
+    BasicTokenizer<CharT> tokenizer(null_io_handler);
+
+    for (const auto& source: {sparse, dense}) {
+        const std::basic_string<CharT> input = repeat(source, 100'000);
+        Result<BasicRootToken<CharT>> root = tokenizer.tokenize(input);
+        CHECK(root.ok());
+        if (root) {
+            const memory_usage_t usage = root->memory_usage();
+            CHECK(usage.slack <= usage.tokens * 2);
+        }
+    }
+}
+
+// Roots, and the lists and tables in them, can only be moved, so none of them can be deep-copied by accident.
+template <typename T>
+constexpr bool is_move_only = !std::is_copy_constructible_v<T> && !std::is_copy_assignable_v<T> &&
+                              std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>;
+
+static_assert(is_move_only<RootToken> && is_move_only<Utf8RootToken>);
+static_assert(is_move_only<TokenList> && is_move_only<Utf8TokenList>);
+static_assert(is_move_only<IdentifierTable> && is_move_only<Utf8IdentifierTable>);
+
+/**
+ * Checks that moving a root hands over the memory its tokens and identifiers are in, rather than copying them. The
+ * columns come from the arena, which a copy need not grow, so what shows a copy is that the root it was made from
+ * still has its tokens.
+ */
+template <typename CharT>
+static void test_moves (const std::basic_string<CharT>& statement) {
+    BasicTokenizer<CharT> tokenizer(null_io_handler);
+    Result<BasicRootToken<CharT>> root = tokenizer.tokenize(repeat(statement, 1'000));
+    CHECK(root.ok());
+    if (!root) {
+        return;
+    }
+
+    const size_t token_count = root->token_vector.size();
+    const CharT* const text = root->token_vector.get_text(token_count - 1).data();
+    const CharT* const identifier = root->identifiers[0].data();
+    const memory_usage_t usage = root->memory_usage();
+
+    BasicRootToken<CharT> assigned(ROOT, UNDEFINED, nullptr, nullptr, token_value_t::none());
+
+    const size_t before = allocations;
+    BasicRootToken<CharT> moved = std::move(*root);
+    CHECK(root->token_vector.empty() && root->identifiers.empty());
+    assigned = std::move(moved);
+    CHECK(moved.token_vector.empty() && moved.identifiers.empty());
+    CHECK(allocations == before);
+
+    CHECK(assigned.token_vector.size() == token_count);
+    CHECK(assigned.token_vector.get_text(token_count - 1).data() == text);
+    CHECK(assigned.identifiers[0].data() == identifier);
+    CHECK(assigned.memory_usage().total() == usage.total());
+}
+
+int main () {
+    test_allocations<char>("let x = a + b * 2; // c\n", "1 + 2.5 * (3 - '4') /* c */;\n");
+    test_allocations<char16_t>(u"let x = a + b * 2; // c\n", u"1 + 2.5 * (3 - '4') /* c */;\n");
+    test_reserve<char>("f({a: [1, 2, 3], b: 'a long string literal'}); /* and a comment */\n", "a;b;c;d;\n");
+    test_reserve<char16_t>(u"f({a: [1, 2, 3], b: 'a long string literal'}); /* and a comment */\n", u"a;b;c;d;\n");
+    test_moves<char>("let x = a + b * 2; // c\n");
+    test_moves<char16_t>(u"let x = a + b * 2; // c\n");
+    return check_failures != 0;
+}
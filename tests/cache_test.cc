@@ -0,0 +1,239 @@
+#include <TokenCache.h>
+#include <Tokenizer.h>
+#include "check.h"
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SOURCE \
+    "const answer = 42, half = 1.5, name = 'it\\'s';\n" \
+    "function f(a, b) { return a / b / 2 + /ab+c/g.test(name); }\n" \
+    "/* done */ export default f;\n"
+
+/**
+ * @return The paths of the entries in a cache directory, without its temporary files.
+ */
+static std::vector<std::string> list_entries (const std::string& directory) {
+    std::vector<std::string> rv;
+    DIR* dir = opendir(directory.c_str());
+    if (dir == nullptr) {
+        return rv;
+    }
+
+    const std::string_view extension = TOKEN_CACHE_EXTENSION;
+    while (dirent* item = readdir(dir)) {
+        std::string name = item->d_name;
+        if (name.size() > extension.size() && name.compare(name.size() - extension.size(), extension.size(),
+                                                           extension) == 0) {
+            rv.push_back(directory + "/" + name);
+        }
+    }
+    closedir(dir);
+    return rv;
+}
+
+static std::string read_file (const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void write_file (const std::string& path, const std::string& bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), (std::streamsize) bytes.size());
+}
+
+/**
+ * Checks that a root rebuilt from the cache has the same tokens and identifiers as the one that was stored.
+ */
+template <typename CharT>
+static void check_same (const BasicRootToken<CharT>& cached, const BasicRootToken<CharT>& root) {
+    CHECK(cached.token_vector.size() == root.token_vector.size());
+    CHECK(cached.identifiers.size() == root.identifiers.size());
+    for (size_t i = 0; i < std::min(cached.token_vector.size(), root.token_vector.size()); ++i) {
+        CHECK(cached.token_vector.get_type(i) == root.token_vector.get_type(i));
+        CHECK(cached.token_vector.get_subtype(i) == root.token_vector.get_subtype(i));
+        CHECK(cached.token_vector.get_text(i).data() == root.token_vector.get_text(i).data());
+        CHECK(cached.token_vector.get_text(i).size() == root.token_vector.get_text(i).size());
+        // Decoded strings are not cached, and are decoded again when asked for.
+        if (root.token_vector.get_value(i).tag != STRING_VALUE) {
+            CHECK(cached.token_vector.get_value(i).tag == root.token_vector.get_value(i).tag);
+            CHECK(cached.token_vector.get_value(i).bits == root.token_vector.get_value(i).bits);
+        }
+    }
+    for (uint32_t id = 0; id < std::min(cached.identifiers.size(), root.identifiers.size()); ++id) {
+        CHECK(cached.identifiers[id] == root.identifiers[id]);
+    }
+}
+
+/**
+ * Stores the tokens of a source, and checks that they are found again, but not for other content, and not once the
+ * entry is damaged or has the header of another version.
+ */
+template <typename CharT>
+static void test_hits_and_misses (const std::string& directory, const std::basic_string<CharT>& source) {
+    BasicTokenCache<CharT> cache(directory.c_str(), TOKEN_CACHE_DEFAULT_SIZE);
+    CHECK(cache.open() == SUCCESS);
+
+    BasicTokenizer<CharT> tokenizer(null_io_handler);
+    Result<BasicRootToken<CharT>> root = tokenizer.tokenize(source);
+    CHECK(root.ok());
+    if (!root) {
+        return;
+    }
+
+    CHECK(!cache.find(source).has_value());
+    cache.store(source, *root);
+
+    const std::vector<std::string> entries = list_entries(directory);
+    CHECK(entries.size() == 1);
+    if (entries.size() != 1) {
+        return;
+    }
+    const std::string entry = entries[0];
+    const std::string bytes = read_file(entry);
+
+    std::optional<BasicRootToken<CharT>> cached = cache.find(source);
+    CHECK(cached.has_value());
+    if (cached) {
+        check_same(*cached, *root);
+    }
+
+    // Other content, even of the same size, misses.
+    std::basic_string<CharT> other = source;
+    other[0] = 'C';
+    CHECK(!cache.find(other).has_value());
+    CHECK(!cache.find(source.substr(1)).has_value());
+
+    const auto misses_with = [&] (const std::string& damaged) {
+        write_file(entry, damaged);
+        bool rv = !cache.find(source).has_value();
+        write_file(entry, bytes);
+        return rv;
+    };
+
+    const auto with_header = [&] (auto change) {
+        token_cache_header_t header;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        change(header);
+        return std::string((const char*) &header, sizeof(header)) + bytes.substr(sizeof(header));
+    };
+
+    // Written by another lexer or in another layout: the tokens may not be the ones this build would produce.
+    CHECK(misses_with(with_header([] (token_cache_header_t& h) { h.tokenizer_version--; })));
+    CHECK(misses_with(with_header([] (token_cache_header_t& h) { h.tokenizer_version++; })));
+    CHECK(misses_with(with_header([] (token_cache_header_t& h) { h.format_version--; })));
+    CHECK(misses_with(with_header([] (token_cache_header_t& h) { h.magic[0] = 'X'; })));
+    CHECK(misses_with(with_header([] (token_cache_header_t& h) { h.code_unit_size = 3 - sizeof(CharT); })));
+    CHECK(misses_with(with_header([] (token_cache_header_t& h) { h.content_hash ^= 1; })));
+    CHECK(misses_with(with_header([] (token_cache_header_t& h) { h.token_count = UINT64_MAX; })));
+    CHECK(misses_with(with_header([] (token_cache_header_t& h) { h.identifier_count = UINT64_MAX; })));
+
+    // Cut short anywhere.
+    for (size_t size = 0; size < bytes.size(); size += 1 + size / 4) {
+        CHECK(misses_with(bytes.substr(0, size)));
+    }
+
+    token_cache_record_t record;
+    std::string damaged = bytes;
+    std::memcpy(&record, bytes.data() + sizeof(token_cache_header_t), sizeof(record));
+    record.end = source.size() + 1;
+    std::memcpy(damaged.data() + sizeof(token_cache_header_t), &record, sizeof(record));
+    CHECK(misses_with(damaged));
+
+    std::memcpy(&record, bytes.data() + sizeof(token_cache_header_t), sizeof(record));
+    record.value_tag = STRING_VALUE;
+    std::memcpy(damaged.data() + sizeof(token_cache_header_t), &record, sizeof(record));
+    CHECK(misses_with(damaged));
+
+    // And the entry is a hit again once it is whole.
+    CHECK(cache.find(source).has_value());
+    unlink(entry.c_str());
+    CHECK(!cache.find(source).has_value());
+}
+
+/**
+ * Stores more entries than the cache has room for, and checks that the ones that were used the longest ago are
+ * removed, and that a hit counts as a use.
+ */
+static void test_eviction (const std::string& directory) {
+    // Sources of the same size, with identifiers of the same size, so that their entries are too.
+    Utf8Tokenizer tokenizer(null_io_handler);
+    std::vector<std::string> sources;
+    std::vector<Utf8RootToken> roots;
+    for (size_t i = 0; i < 5; ++i) {
+        sources.push_back("let x" + std::to_string(1000 + i) + " = 1;\n" SOURCE);
+        Result<Utf8RootToken> root = tokenizer.tokenize(sources.back());
+        CHECK(root.ok());
+        if (!root) {
+            return;
+        }
+        roots.push_back(std::move(*root));
+    }
+
+    uint64_t entry_size = 0;
+    {
+        Utf8TokenCache measure(directory.c_str(), TOKEN_CACHE_DEFAULT_SIZE);
+        CHECK(measure.open() == SUCCESS);
+        measure.store(sources[0], roots[0]);
+        for (const auto& entry: list_entries(directory)) {
+            entry_size = read_file(entry).size();
+            unlink(entry.c_str());
+        }
+        CHECK(entry_size > 0);
+    }
+
+    // Room for four entries, so that storing a fifth evicts down to three.
+    Utf8TokenCache cache(directory.c_str(), entry_size * 4);
+    CHECK(cache.open() == SUCCESS);
+
+    // Modification times only have to be as fine as seconds, so the entries are dated a second apart by hand, in the
+    // order they were stored, and in the past, so that a hit makes its entry the most recently used.
+    const time_t base = std::time(nullptr) - 1000;
+    for (size_t i = 0; i < 4; ++i) {
+        const std::vector<std::string> before = list_entries(directory);
+        cache.store(sources[i], roots[i]);
+        for (const auto& entry: list_entries(directory)) {
+            if (std::find(before.begin(), before.end(), entry) == before.end()) {
+                const timespec times[2] = {{base + (time_t) i, 0}, {base + (time_t) i, 0}};
+                CHECK(utimensat(AT_FDCWD, entry.c_str(), times, 0) == 0);
+            }
+        }
+    }
+    CHECK(list_entries(directory).size() == 4);
+
+    // The oldest entry is used again, which leaves the next two as the ones used the longest ago.
+    CHECK(cache.find(sources[0]).has_value());
+    cache.store(sources[4], roots[4]);
+
+    uint64_t total = 0;
+    for (const auto& entry: list_entries(directory)) {
+        total += read_file(entry).size();
+    }
+    CHECK(total <= entry_size * 3);
+
+    CHECK(!cache.find(sources[1]).has_value());
+    CHECK(!cache.find(sources[2]).has_value());
+    CHECK(cache.find(sources[0]).has_value());
+    CHECK(cache.find(sources[3]).has_value());
+    CHECK(cache.find(sources[4]).has_value());
+}
+
+int main () {
+    char directory[] = "/tmp/m6_cache_test_XXXXXX";
+    CHECK(mkdtemp(directory) != nullptr);
+
+    test_hits_and_misses<char>(directory, SOURCE);
+    test_hits_and_misses<char16_t>(directory, u"" SOURCE);
+    test_eviction(directory);
+
+    for (const auto& entry: list_entries(directory)) {
+        unlink(entry.c_str());
+    }
+    rmdir(directory);
+
+    return check_failures != 0;
+}
@@ -0,0 +1,71 @@
+#include <Token.h>
+#include "check.h"
+#include <climits>
+
+// The predicates as they were before CHARACTER_CLASSES, which the table has to agree with on every code unit.
+
+static bool old_is_digit (const char16_t c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool old_is_hexadecimal_digit (const char16_t c) {
+    return (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+static bool old_is_identifier (const char16_t c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '$';
+}
+
+static bool old_is_whitespace (const char16_t c) {
+    for (size_t i = 0; i < sizeof(WHITESPACE_CHARACTERS) / sizeof(char) - 1; ++i) {
+        if (c == WHITESPACE_CHARACTERS[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool old_is_punctuation (const char16_t c) {
+    for (size_t i = 0; i < sizeof(PUNCTUATION_CHARACTERS) / sizeof(char) - 1; ++i) {
+        if (c == PUNCTUATION_CHARACTERS[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool old_is_line_terminator (const char16_t c) {
+    return c == '\r' || c == '\n';
+}
+
+/**
+ * Checks every predicate of BasicToken<CharT> against the old one on c.
+ * @return Whether they all agreed, so that a disagreement is only reported once per code unit.
+ */
+template <typename CharT>
+static bool agrees (const char16_t c) {
+    typedef BasicToken<CharT> token_t;
+    return token_t::is_digit(c) == old_is_digit(c) &&
+           token_t::is_hexadecimal_digit(c) == old_is_hexadecimal_digit(c) &&
+           token_t::is_identifier(c) == old_is_identifier(c) &&
+           token_t::is_whitespace(c) == old_is_whitespace(c) &&
+           token_t::is_punctuation(c) == old_is_punctuation(c) &&
+           token_t::is_line_terminator(c) == old_is_line_terminator(c) &&
+           token_t::is_in_class(c, CHAR_IDENTIFIER | CHAR_DIGIT) == (old_is_identifier(c) || old_is_digit(c)) &&
+           token_t::is_in_class(c, CHAR_DIGIT | CHAR_HEXADECIMAL) == (old_is_digit(c) ||
+                                                                     old_is_hexadecimal_digit(c));
+}
+
+int main () {
+    // Every UTF-16 code unit.
+    for (uint32_t c = 0; c <= 0xFFFF; ++c) {
+        CHECK(agrees<char16_t>((char16_t) c));
+    }
+
+    // Every byte, widened the way the UTF-8 lexer widens it, sign extension and all.
+    for (int c = CHAR_MIN; c <= CHAR_MAX; ++c) {
+        CHECK(agrees<char>((char16_t) (char) c));
+    }
+
+    return check_failures != 0;
+}
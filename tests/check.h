@@ -0,0 +1,18 @@
+#ifndef M6_CHECK_H
+#define M6_CHECK_H
+
+#include <cstdio>
+
+// Every test is a program of its own. A failed check is written to stderr along with where it is, and the test
+// goes on, so that one run shows every failure. The test fails (returns non-zero) if any check did.
+inline int check_failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            ++check_failures; \
+        } \
+    } while (0)
+
+#endif
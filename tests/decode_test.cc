@@ -0,0 +1,186 @@
+#include <Tokenizer.h>
+#include <utf.h>
+#include "check.h"
+
+using namespace std::string_literals;
+
+/*
+ * The body of a string literal as it is written between its quotes, and the value it decodes to, both in UTF-8.
+ */
+typedef struct {
+    std::string body;
+    std::string value;
+} escape_case_t;
+
+static const escape_case_t ESCAPES[] = {
+    {R"(\b\f\n\r\t\v)", "\b\f\n\r\t\v"},
+    {R"(\'\"\\)", R"('"\)"},
+    {R"(\q\$\é)", "q$é"},  // Any other escaped code unit stands for itself.
+    {R"(\x41\x7a\xe9\x00)", "Azé\0"s},
+    {R"(\u0041\u00e9\u4e2d\uFFFD)", "Aé中\uFFFD"},
+    {R"(\u{41}\u{0000e9}\u{1F600}\u{10FFFF})", "Aé😀\U0010FFFF"},
+    {R"(\uD83D\uDE00!\ud83d\ude00)", "😀!😀"},
+    {R"(\0\101\1012\400\08\7a)", "\0A" "A2" " 0" "\0" "8" "\7a"s},
+    {"a\\\nb\\\r\nc\\\rd", "abcd"},
+    {"a\\\u2028b\\\u2029c", "abc"},
+};
+
+// Escapes that cannot be decoded, each after an "a" that is decoded before it.
+static const char* const MALFORMED[] = {
+    R"(a\x4)", R"(a\xg1)", R"(a\u12)", R"(a\u12g4)", R"(a\u{})", R"(a\u{110000})", R"(a\u{41)", R"(a\u{4g})",
+    R"(a\uD83D\u12g4)", "a\\",
+};
+
+/**
+ * The same text in the code units of CharT.
+ */
+template <typename CharT>
+static std::basic_string<CharT> units (const std::string& utf8) {
+    if constexpr (std::is_same_v<CharT, char>) {
+        return utf8;
+    } else {
+        std::u16string rv;
+        CHECK(fromUTF8(utf8, rv) == SUCCESS);
+        return rv;
+    }
+}
+
+/**
+ * Tokenizes a source, which has to lex, and has to outlive the root.
+ */
+template <typename CharT>
+static std::optional<BasicRootToken<CharT>> tokenize (BasicTokenizer<CharT>& tokenizer,
+                                                      const std::basic_string<CharT>& source) {
+    Result<BasicRootToken<CharT>> root = tokenizer.tokenize(source);
+    CHECK(root.ok());
+    if (!root) {
+        return std::nullopt;
+    }
+    return std::move(*root);
+}
+
+/**
+ * @return The index of the first token of the given type, or the number of tokens if there is none.
+ */
+template <typename CharT>
+static size_t find_token (const BasicRootToken<CharT>& root, const token_type_t type) {
+    size_t i = 0;
+    while (i < root.token_vector.size() && root.token_vector.get_type(i) != type) {
+        ++i;
+    }
+    CHECK(i < root.token_vector.size());
+    return i;
+}
+
+/**
+ * Decodes every escape, both on its own and in a string literal that is tokenized, and checks that malformed ones
+ * fail without stopping the literal from lexing.
+ */
+template <typename CharT>
+static void test_escapes () {
+    BasicTokenizer<CharT> tokenizer(null_io_handler);
+    std::basic_string<CharT> result;
+
+    for (const auto& escape: ESCAPES) {
+        const std::basic_string<CharT> value = units<CharT>(escape.value);
+        CHECK(BasicToken<CharT>::decode_string(units<CharT>(escape.body), result) == SUCCESS);
+        CHECK(result == value);
+
+        for (const char* quote: {"\"", "'"}) {
+            const std::basic_string<CharT> source = units<CharT>("s = "s + quote + escape.body + quote + ";\n");
+            if (auto root = tokenize(tokenizer, source)) {
+                Result<std::basic_string_view<CharT>> decoded = root->get_string(find_token(*root, STRING));
+                CHECK(decoded.ok() && *decoded == value);
+            }
+        }
+    }
+
+    for (const char* malformed: MALFORMED) {
+        CHECK(BasicToken<CharT>::decode_string(units<CharT>(malformed), result) == ERR_INVALID_ESCAPE);
+        CHECK(result.substr(0, 1) == units<CharT>("a"));
+
+        // A backslash right before the closing quote escapes it, so that one cannot be in a literal.
+        if (std::string_view(malformed).back() != '\\') {
+            const std::basic_string<CharT> source = units<CharT>("s = '"s + malformed + "';\n");
+            if (auto root = tokenize(tokenizer, source)) {
+                CHECK(root->get_string(find_token(*root, STRING)).get_error() == ERR_INVALID_ESCAPE);
+            }
+        }
+    }
+}
+
+/**
+ * Checks that a literal without escapes is handed out as it is, rather than decoded into the string table.
+ */
+template <typename CharT>
+static void test_unchanged () {
+    BasicTokenizer<CharT> tokenizer(null_io_handler);
+    const std::basic_string<CharT> source = units<CharT>("s = 'plain text, ü and 中 included';\n");
+
+    auto root = tokenize(tokenizer, source);
+    if (!root) {
+        return;
+    }
+
+    const size_t index = find_token(*root, STRING);
+    Result<std::basic_string_view<CharT>> decoded = root->get_string(index);
+    CHECK(decoded.ok());
+    if (decoded) {
+        CHECK(*decoded == units<CharT>("plain text, ü and 中 included"));
+        CHECK(decoded->data() == source.data() + 5);
+    }
+    CHECK(root->strings.size() == 0);
+    CHECK(root->token_vector.get_value(index).tag == NO_VALUE);
+}
+
+/**
+ * Checks the sources that lex differently now that backslashes escape the code unit after them in every range.
+ */
+template <typename CharT>
+static void test_lexer () {
+    BasicTokenizer<CharT> tokenizer(null_io_handler);
+
+    // A line comment that ends in a backslash still ends at the end of its line.
+    const std::basic_string<CharT> commented = units<CharT>("// c\\\nx = 1;\n");
+    if (auto root = tokenize(tokenizer, commented)) {
+        const size_t comment = find_token(*root, COMMENT);
+        CHECK(root->token_vector.get_text(comment) == units<CharT>("// c\\"));
+        const size_t identifier = find_token(*root, IDENTIFIER);
+        CHECK(root->token_vector.get_text(identifier) == units<CharT>("x"));
+        CHECK(root->token_vector.get_offset(identifier) == 6);
+    }
+
+    // An escaped backslash does not escape the quote after it.
+    const std::basic_string<CharT> escaped = units<CharT>("s = \"a\\\\\"; t = 'b\\\\';\n");
+    if (auto root = tokenize(tokenizer, escaped)) {
+        const size_t first = find_token(*root, STRING);
+        Result<std::basic_string_view<CharT>> decoded = root->get_string(first);
+        CHECK(decoded.ok() && *decoded == units<CharT>("a\\"));
+        CHECK(root->token_vector.get_text(first) == units<CharT>("\"a\\\\\""));
+        size_t strings = 0;
+        for (auto token: root->token_vector) {
+            strings += token.get_type() == STRING;
+        }
+        CHECK(strings == 2);
+    }
+
+    // A line continuation goes on with the literal on the next line.
+    const std::basic_string<CharT> continued = units<CharT>("s = 'a\\\nb';\nt = 1;\n");
+    if (auto root = tokenize(tokenizer, continued)) {
+        const size_t string = find_token(*root, STRING);
+        CHECK(root->token_vector.get_text(string) == units<CharT>("'a\\\nb'"));
+        Result<std::basic_string_view<CharT>> decoded = root->get_string(string);
+        CHECK(decoded.ok() && *decoded == units<CharT>("ab"));
+    }
+}
+
+int main () {
+    test_escapes<char>();
+    test_escapes<char16_t>();
+    test_unchanged<char>();
+    test_unchanged<char16_t>();
+    test_lexer<char>();
+    test_lexer<char16_t>();
+
+    return check_failures != 0;
+}
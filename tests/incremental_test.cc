@@ -0,0 +1,189 @@
+#include <IncrementalTokenizer.h>
+#include "check.h"
+#include <optional>
+#include <random>
+#include <tuple>
+
+// How many random edits each document goes through, starting over from the document every EDIT_RESTART edits, since
+// random edits leave it broken more often than not.
+#define EDIT_COUNT 4'000
+#define EDIT_RESTART 100
+
+// What a test compares tokens by, since identifier ids can differ between an edited root and a fresh one.
+template <typename CharT>
+struct token_record_t {
+    token_type_t type;
+    token_subtype_t subtype;
+    std::basic_string<CharT> text;
+    token_value_tag_t tag;
+    uint64_t bits;  // The identifier itself stands in for the id, in text.
+
+    bool operator== (const token_record_t& other) const {
+        return this->type == other.type && this->subtype == other.subtype && this->text == other.text &&
+               this->tag == other.tag && (this->tag == IDENTIFIER_VALUE || this->bits == other.bits);
+    }
+};
+
+template <typename CharT>
+static std::vector<token_record_t<CharT>> records (const BasicRootToken<CharT>& root) {
+    std::vector<token_record_t<CharT>> rv;
+    for (auto token: root.token_vector) {
+        const token_value_t value = token.get_value();
+        rv.push_back({token.get_type(), token.get_subtype(), std::basic_string<CharT>(token.get_text()),
+                      value.tag, value.bits});
+        if (value.tag == IDENTIFIER_VALUE) {
+            CHECK(root.identifiers[token.get_identifier()] == token.get_text());
+        }
+    }
+    return rv;
+}
+
+/**
+ * Applies an edit, and checks that the tokens are those of tokenizing the edited document from scratch, and that the
+ * diff turns the tokens from before the edit into those after it.
+ * @param incremental
+ * @param reported The tokens from before the edit, which become those after it if it succeeded.
+ * @return Whether the edit left the document valid.
+ */
+template <typename CharT>
+static bool check_edit (BasicIncrementalTokenizer<CharT>& incremental, std::vector<token_record_t<CharT>>& reported,
+                        const size_t offset, const size_t removed, const std::basic_string<CharT>& inserted) {
+    std::basic_string<CharT> content(incremental.get_content());
+    content.replace(offset, removed, inserted);
+
+    Result<token_diff_t> diff = incremental.edit(offset, removed, inserted);
+    CHECK(incremental.get_content() == content);
+
+    BasicTokenizer<CharT> fresh(null_io_handler);
+    Result<BasicRootToken<CharT>> expected = fresh.tokenize(content);
+    CHECK(diff.get_error() == expected.get_error());
+    if (!diff || !expected) {
+        return false;
+    }
+
+    const std::vector<token_record_t<CharT>> actual = records(incremental.get_root());
+    CHECK(actual == records(*expected));
+
+    bool offsets_match = actual.size() == expected->token_vector.size();
+    for (size_t i = 0; offsets_match && i < actual.size(); ++i) {
+        offsets_match = incremental.get_root().token_vector.get_offset(i) == expected->token_vector.get_offset(i);
+    }
+    CHECK(offsets_match);
+
+    CHECK(diff->first + diff->removed <= reported.size());
+    CHECK(diff->first + diff->inserted <= actual.size());
+    if (diff->first + diff->removed <= reported.size() && diff->first + diff->inserted <= actual.size()) {
+        std::vector<token_record_t<CharT>> patched(reported.begin(), reported.begin() + diff->first);
+        patched.insert(patched.end(), actual.begin() + diff->first, actual.begin() + diff->first + diff->inserted);
+        patched.insert(patched.end(), reported.begin() + diff->first + diff->removed, reported.end());
+        CHECK(patched == actual);
+    }
+
+    reported = actual;
+    return true;
+}
+
+/**
+ * Edits a document at random, with pieces that open and close every kind of range, checking every edit.
+ */
+template <typename CharT>
+static void test_random_edits (const std::basic_string<CharT>& document,
+                               const std::vector<std::basic_string<CharT>>& pieces) {
+    std::mt19937 random(0x6d36);  // Fixed, so that a failure can be reproduced.
+
+    BasicIncrementalTokenizer<CharT> incremental(null_io_handler);
+    std::vector<token_record_t<CharT>> reported;
+
+    size_t valid_edits = 0;
+    std::optional<std::tuple<size_t, size_t, std::basic_string<CharT>>> undo;  // Of the last edit, if it broke.
+    for (size_t i = 0; i < EDIT_COUNT; ++i) {
+        if (i % EDIT_RESTART == 0) {
+            Result<BasicRootToken<CharT>*> root = incremental.tokenize(document);
+            CHECK(root.ok());
+            if (!root) {
+                return;
+            }
+            reported = records(**root);
+            undo.reset();
+        }
+
+        // Half of the edits that break the document are undone, which then has to be tokenized from scratch.
+        const size_t size = incremental.get_content().size();
+        size_t offset = random() % (size + 1);
+        size_t removed = random() % 3 == 0 ? random() % std::min<size_t>(size - offset + 1, 8) : 0;
+        std::basic_string<CharT> inserted = pieces[random() % pieces.size()];
+        if (undo.has_value() && random() % 2 == 0) {
+            std::tie(offset, removed, inserted) = *undo;
+        }
+
+        undo.emplace(offset, inserted.size(), incremental.get_content().substr(offset, removed));
+        if (check_edit(incremental, reported, offset, removed, inserted)) {
+            ++valid_edits;
+            undo.reset();
+        }
+    }
+
+    // Enough of the edits have to leave the document valid for the test to mean much.
+    CHECK(valid_edits > EDIT_COUNT / 4);
+
+    // Edits past the end of the buffer are not applied.
+    const size_t size = incremental.get_content().size();
+    CHECK(incremental.edit(size + 1, 0, pieces[0]).get_error() == ERR_INVALID_EDIT);
+    CHECK(incremental.edit(size, 1, pieces[0]).get_error() == ERR_INVALID_EDIT);
+    CHECK(incremental.get_content().size() == size);
+}
+
+/**
+ * Edits the token before a '/' into one that makes it the other of a regex or a division, with tokens that the
+ * lookbehind skips over in between, which come out the same as before the edit but cannot be lined up at.
+ */
+template <typename CharT>
+static void test_lookbehind_edits (const std::basic_string<CharT>& document, const std::basic_string<CharT>& from,
+                                   const std::basic_string<CharT>& to) {
+    for (size_t offset = document.find(from); offset != std::basic_string<CharT>::npos;
+         offset = document.find(from, offset + 1)) {
+        BasicIncrementalTokenizer<CharT> incremental(null_io_handler);
+        Result<BasicRootToken<CharT>*> root = incremental.tokenize(document);
+        CHECK(root.ok());
+        if (!root) {
+            return;
+        }
+
+        std::vector<token_record_t<CharT>> reported = records(**root);
+        CHECK(check_edit(incremental, reported, offset, from.size(), to));
+        CHECK(check_edit(incremental, reported, offset, to.size(), from));
+    }
+}
+
+#define DOCUMENT \
+    "const a = 1, b = 'two', c = `three ${a + 1}`;\n" \
+    "/* a block\n   comment */\n" \
+    "function f(x, y) {\n" \
+    "    // a line comment\n" \
+    "    return x / y / 2 + /ab+c/g.test(b) ? [x, y] : {x: y};\n" \
+    "}\n" \
+    "let d = a\n" \
+    "/ 2 /g;\n" \
+    "if (a === 1 && !b) { d++; } else { d--; }\n"
+
+// Every '/' is a division after "a", and a regex after "=".
+#define LOOKBEHIND_DOCUMENT \
+    "x = a\n/ 2 /g;\n" \
+    "x = a /* c */ / 2 /g;\n" \
+    "x = a // c\n/ 2 /g;\n" \
+    "x = a\n\n/* c\n */ / 2 /g;\n"
+
+#define PIECES(prefix) \
+    {prefix"x", prefix" ", prefix"\n", prefix";", prefix"1", prefix"/", prefix"*", prefix"/*", prefix"*/", \
+     prefix"//", prefix"'", prefix"\"", prefix"`", prefix"${", prefix"}", prefix"{", prefix"(", prefix")", \
+     prefix"[", prefix"]", prefix"\\", prefix"=", prefix"+", prefix"++", prefix"let", prefix"return"}
+
+int main () {
+    test_random_edits<char>(DOCUMENT, PIECES(""));
+    test_random_edits<char16_t>(u"" DOCUMENT, PIECES(u""));
+
+    test_lookbehind_edits<char>(LOOKBEHIND_DOCUMENT, "a", "=");
+    test_lookbehind_edits<char16_t>(u"" LOOKBEHIND_DOCUMENT, u"a", u"=");
+
+    return check_failures != 0;
+}
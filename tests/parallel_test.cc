@@ -0,0 +1,116 @@
+#include <ParallelTokenizer.h>
+#include "check.h"
+#include <cstring>
+
+// How many code units the input has per job, enough for every job to get a chunk of its own.
+#define UNITS_PER_JOB (PARALLEL_MIN_CHUNK_SIZE + 0x01'00'00 / 8)
+
+// A statement that starts its line with an identifier, which is where splits are looked for.
+#define FILLER "a = b / 2;\n"
+
+/*
+ * Something that starts on a line of its own before the point a split is looked for, and goes on past it. The
+ * opener's line is padded with spaces up to that point, and then the first line that starts with an identifier
+ * (and so where the split lands) is in the middle of whatever the opener opened.
+ */
+typedef struct {
+    const char* opener;
+    const char* rest;
+} construct_t;
+
+static const construct_t CONSTRUCTS[] = {
+    // Nothing, so that the split lands on a statement, and the chunk after it is adopted as it was guessed.
+    {"", ""},
+    {"t = `${a}", "\nfoo ${b / 2} /* not a comment */ 'not a string'\nbar`;\n"},
+    {"/* c", "\nfoo = `not a template\nbar */\n"},
+    {"s = 'a", "\\\nfoo \" /* \\' bar';\n"},
+    {"f({a: [1,", "\nfoo, `x`, /y/g\n]});\n"},
+    // Regexes do not span lines, so a split cannot land in one. Instead, the split is right after a regex that
+    // looks like it opens everything else, and is right before a '/' that the lookbehind has to tell apart.
+    {"r = /[`'\"]\\/* c/g.test(s)", "\nfoo\n/ 2 /g;\n/ab+c/g.test(s);\n"},
+};
+
+/**
+ * Builds an input of jobs * UNITS_PER_JOB code units, with a construct across every point where a split is looked
+ * for. The constructs take turns, starting with the one at first.
+ */
+template <typename CharT>
+static std::basic_string<CharT> make_input (const size_t jobs, const size_t first) {
+    const size_t n = jobs * UNITS_PER_JOB;
+    std::string rv;
+
+    for (size_t i = 1; i < jobs; ++i) {
+        const size_t target = n * i / jobs;
+        const construct_t& construct = CONSTRUCTS[(first + i) % std::size(CONSTRUCTS)];
+
+        while (rv.size() + sizeof(FILLER) - 1 + std::strlen(construct.opener) < target) {
+            rv += FILLER;
+        }
+        rv += construct.opener;
+        rv.append(target + 1 - std::min(target + 1, rv.size()), ' ');
+        rv += construct.rest;
+    }
+
+    while (rv.size() + sizeof(FILLER) - 1 <= n) {
+        rv += FILLER;
+    }
+    rv.append(n - rv.size(), '\n');
+
+    return std::basic_string<CharT>(rv.begin(), rv.end());
+}
+
+/**
+ * Checks that tokenizing an input on several threads gives the same tokens and identifiers as tokenizing it on one,
+ * or fails the same way.
+ * @return What tokenizing the input on one thread returned.
+ */
+template <typename CharT>
+static err_t test_parallel (const std::basic_string<CharT>& input, const size_t jobs) {
+    BasicTokenizer<CharT> serial(null_io_handler);
+    BasicParallelTokenizer<CharT> parallel(null_io_handler, jobs);
+
+    Result<BasicRootToken<CharT>> expected = serial.tokenize(input);
+    Result<BasicRootToken<CharT>> actual = parallel.tokenize(input);
+    CHECK(actual.get_error() == expected.get_error());
+    if (!expected || !actual) {
+        return expected.get_error();
+    }
+
+    const auto& expected_tokens = expected->token_vector;
+    const auto& actual_tokens = actual->token_vector;
+    CHECK(actual_tokens.size() == expected_tokens.size());
+    CHECK(actual->identifiers.size() == expected->identifiers.size());
+
+    bool same = true;
+    for (size_t i = 0; i < std::min(actual_tokens.size(), expected_tokens.size()); ++i) {
+        same = same && actual_tokens.get_type(i) == expected_tokens.get_type(i) &&
+               actual_tokens.get_subtype(i) == expected_tokens.get_subtype(i) &&
+               actual_tokens.get_offset(i) == expected_tokens.get_offset(i) &&
+               actual_tokens.get_length(i) == expected_tokens.get_length(i) &&
+               actual_tokens.get_value(i).tag == expected_tokens.get_value(i).tag &&
+               actual_tokens.get_value(i).bits == expected_tokens.get_value(i).bits;
+    }
+    CHECK(same);
+
+    for (uint32_t id = 0; id < std::min(actual->identifiers.size(), expected->identifiers.size()); ++id) {
+        CHECK(actual->identifiers[id] == expected->identifiers[id]);
+    }
+
+    return SUCCESS;
+}
+
+int main () {
+    for (const size_t jobs: {2, 3, 8}) {
+        for (size_t first = 0; first < std::size(CONSTRUCTS); ++first) {
+            CHECK(test_parallel(make_input<char>(jobs, first), jobs) == SUCCESS);
+            CHECK(test_parallel(make_input<char16_t>(jobs, first), jobs) == SUCCESS);
+        }
+    }
+
+    // A syntax error in the last chunk fails the same way.
+    std::string broken = make_input<char>(4, 0);
+    broken.back() = '#';
+    CHECK(test_parallel(broken, 4) == ERR_TOKENIZING_SYNTAX_ERROR);
+
+    return check_failures != 0;
+}
@@ -0,0 +1,68 @@
+#include <scan.h>
+#include "check.h"
+#include <vector>
+
+// Where the runs start, relative to an aligned buffer, so that they start at every position of a block.
+#define MAX_OFFSET 32
+#define MAX_RUN 100
+
+/**
+ * The end of the run at begin, one code unit at a time, as the lexer found it before the block scanners.
+ */
+template <typename CharT>
+static const CharT* scalar_skip (const CharT* begin, const CharT* const end, const char_class_t classes) {
+    for (; begin != end && BasicToken<CharT>::is_in_class(*begin, classes); ++begin);
+    return begin;
+}
+
+/**
+ * Checks a scanner against the scalar loop, on runs of every length up to MAX_RUN that start at every offset up to
+ * MAX_OFFSET. Every run is made of members cycled through, so that each member shows up at every position of a block.
+ * A run ends at one of the stoppers, followed by more of the run, or at the '\0' at end.
+ * @param skip The scanner.
+ * @param classes The classes of the run.
+ * @param members Every code unit in the run's classes.
+ * @param stoppers Code units that are not, the ones that only look like members in their low byte included.
+ */
+template <typename CharT, typename SkipT>
+static void test_scanner (SkipT skip, const char_class_t classes,
+                          const std::basic_string<CharT>& members, const std::basic_string<CharT>& stoppers) {
+    for (size_t offset = 0; offset < MAX_OFFSET; ++offset) {
+        for (size_t length = 0; length <= MAX_RUN; ++length) {
+            // A stopper, or none so that the run goes on to end.
+            for (size_t stopper = 0; stopper <= stoppers.size(); ++stopper) {
+                std::vector<CharT> buffer(offset, '-');
+                for (size_t i = 0; i < length; ++i) {
+                    buffer.push_back(members[(i + offset) % members.size()]);
+                }
+                if (stopper < stoppers.size()) {
+                    buffer.push_back(stoppers[stopper]);
+                    buffer.insert(buffer.end(), members.begin(), members.end());
+                }
+                buffer.push_back('\0');
+
+                const CharT* const begin = buffer.data() + offset;
+                const CharT* const end = buffer.data() + buffer.size() - 1;
+                const CharT* const expected = scalar_skip(begin, end, classes);
+                CHECK(expected == begin + length);
+                CHECK(skip(begin, end) == expected);
+            }
+        }
+    }
+}
+
+int main () {
+    test_scanner<char>(skip_whitespace<char>, CHAR_WHITESPACE, "\t\v\f\r ", "\na/\x80\xa0\xc2");
+    // Code units whose low byte is a space, a tab or a carriage return.
+    test_scanner<char16_t>(skip_whitespace<char16_t>, CHAR_WHITESPACE, u"\t\v\f\r ",
+                           u"\na/\u0080\u00a0\u0920\u0909\u090d\u2009");
+
+    test_scanner<char>(skip_identifier_part<char>, CHAR_IDENTIFIER | CHAR_DIGIT,
+                       "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_$", " -.(\x80\xc3\xe4");
+    // Code units whose low byte is '0', '$' or 'A', or whose high byte is '_'.
+    test_scanner<char16_t>(skip_identifier_part<char16_t>, CHAR_IDENTIFIER | CHAR_DIGIT,
+                           u"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_$",
+                           u" -.(\u00e9\u0930\u0124\u0141\u5f00");
+
+    return check_failures != 0;
+}
@@ -0,0 +1,193 @@
+#include <StreamTokenizer.h>
+#include "check.h"
+#include <cstdlib>
+#include <new>
+
+// How many bytes the program has allocated and not freed yet. Every allocation keeps its size in front of it.
+static size_t live_bytes = 0;
+
+void* operator new (size_t size) {
+    auto p = (size_t*) std::malloc(size + alignof(std::max_align_t));
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    *p = size;
+    live_bytes += size;
+    return (char*) p + alignof(std::max_align_t);
+}
+
+void operator delete (void* p) noexcept {
+    if (p != nullptr) {
+        auto header = (size_t*) ((char*) p - alignof(std::max_align_t));
+        live_bytes -= *header;
+        std::free(header);
+    }
+}
+
+void operator delete (void* p, size_t) noexcept {
+    operator delete(p);
+}
+
+// What a test compares tokens by, since the tokens handed out by a stream tokenizer do not outlive the handler.
+typedef struct {
+    token_type_t type;
+    token_subtype_t subtype;
+    std::string text;
+} token_record_t;
+
+static bool operator== (const token_record_t& a, const token_record_t& b) {
+    return a.type == b.type && a.subtype == b.subtype && a.text == b.text;
+}
+
+// Lets a test see how many tokens the stream tokenizer holds on to.
+class StreamTokenizerProbe : public Utf8StreamTokenizer {
+public:
+    using Utf8StreamTokenizer::Utf8StreamTokenizer;
+
+    [[nodiscard]] size_t history_size () const {
+        return this->history.size();
+    }
+};
+
+static token_record_t record (Utf8Token& token) {
+    return {token.get_type(), token.get_subtype(), std::string(token.get_text())};
+}
+
+/**
+ * Feeds a source a chunk at a time, and checks that it is tokenized the same as all at once, or fails the same.
+ */
+static void test_chunks (const std::string& source) {
+    std::vector<token_record_t> expected;
+    Utf8Tokenizer whole(null_io_handler);
+    Result<Utf8RootToken> root = whole.tokenize(source);
+    if (root) {
+        for (auto token: root->token_vector) {
+            expected.push_back(record(token));
+        }
+    }
+
+    for (const size_t chunk_size: {1, 2, 3, 7, 4096}) {
+        std::vector<token_record_t> streamed;
+        Utf8StreamTokenizer tokenizer(null_io_handler, [&] (Utf8Token& token) {
+            streamed.push_back(record(token));
+        });
+
+        err_t error = SUCCESS;
+        for (size_t i = 0; i < source.size() && error == SUCCESS; i += chunk_size) {
+            error = tokenizer.feed(source.data() + i, std::min(chunk_size, source.size() - i));
+        }
+        if (error == SUCCESS) {
+            error = tokenizer.finish();
+        }
+
+        CHECK(error == root.get_error());
+        CHECK(error != SUCCESS || streamed == expected);
+    }
+}
+
+/**
+ * Feeds a long stream of tokens that the regex lookbehind looks past (comments, whitespace, line feeds, ++), and
+ * checks that the history does not grow with it, and that a regex after it is still told apart from a division.
+ */
+static void test_history_is_trimmed () {
+    const std::string chunk = "// line comment\n/* block\ncomment */ \t\n++\n";
+    const std::string tail = "/ab+c/g.test(s);\n";
+
+    size_t handled = 0;
+    StreamTokenizerProbe tokenizer(null_io_handler, [&] (Utf8Token&) { ++handled; });
+
+    size_t largest_history = 0;
+    for (size_t i = 0; i < 100'000; ++i) {
+        CHECK(tokenizer.feed(chunk) == SUCCESS);
+        largest_history = std::max(largest_history, tokenizer.history_size());
+    }
+    CHECK(largest_history <= 3);
+
+    // The same again, after a token that the lookbehind stops at.
+    CHECK(tokenizer.feed("x = a\n") == SUCCESS);
+    for (size_t i = 0; i < 100'000; ++i) {
+        CHECK(tokenizer.feed(chunk) == SUCCESS);
+        largest_history = std::max(largest_history, tokenizer.history_size());
+    }
+    CHECK(largest_history <= 3);
+
+    CHECK(tokenizer.feed(tail) == SUCCESS);
+    CHECK(tokenizer.finish() == SUCCESS);
+    CHECK(handled > 0);
+
+    std::string source;
+    for (size_t i = 0; i < 8; ++i) {
+        source += chunk;
+    }
+    test_chunks(source + tail);
+    test_chunks("x = a\n" + source + tail);
+}
+
+/**
+ * Puts every short sequence of tokens that the lookbehind can skip over, or stop at, before a '/', which it then has
+ * to tell apart as a regex or a division with only what is left of the history, one code unit at a time.
+ */
+static void test_lookbehind () {
+    const std::string fragments[] = {" ", "\n", "/* c */", "/*\n*/", "// c\n", "++", "x", "="};
+
+    // After a line that leaves tokens in the history, and without one.
+    for (const std::string prefix: {"", "x = 1\n"}) {
+        for (const auto& a: fragments) {
+            for (const auto& b: fragments) {
+                for (const auto& c: fragments) {
+                    for (const auto& d: fragments) {
+                        test_chunks(prefix + a + b + c + d + "/ 2 /g\n");
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Feeds millions of distinct identifiers, and checks that the memory the stream tokenizer holds on to stays the
+ * same as after the first few thousand, as it keeps no table of them.
+ */
+static void test_distinct_identifiers () {
+    size_t identifiers = 0;
+    bool texts_match = true;
+    std::string expected;
+    Utf8StreamTokenizer tokenizer(null_io_handler, [&] (Utf8Token& token) {
+        if (token.get_type() == IDENTIFIER) {
+            expected = "id" + std::to_string(identifiers++);
+            texts_match = texts_match && token.get_text() == expected && token.get_value().tag == NO_VALUE;
+        }
+    });
+
+    const size_t before = live_bytes;
+    size_t settled = 0, largest = 0;
+    std::string chunk;
+    for (size_t i = 0; i < 2'000'000; ++i) {
+        chunk += "id" + std::to_string(i) + (i % 16 == 15 ? "\n" : " ");
+        if (chunk.size() >= 4096) {
+            CHECK(tokenizer.feed(chunk) == SUCCESS);
+            chunk.clear();
+            largest = std::max(largest, live_bytes - before);
+            if (i < 10'000) {
+                settled = largest;
+            }
+        }
+    }
+    CHECK(tokenizer.feed(chunk) == SUCCESS);
+    CHECK(tokenizer.finish() == SUCCESS);
+
+    CHECK(identifiers == 2'000'000);
+    CHECK(texts_match);
+    // The buffers can still grow a little as the identifiers get longer, but nowhere near a copy of each.
+    CHECK(largest <= settled * 2);
+}
+
+int main () {
+    test_chunks("var a = 1;\nlet s = 'str\\'q';\nx = `tmpl\n${y}\nbar`;\n/* c\n */\nr = /ab+c/g.test(s);\n"
+                "z = a / b / c;\nfunction f(a, b) {\nreturn a + b;\n}\nfoo\n/ 2 /\n1;\nu = x++ / 2;\n");
+    test_history_is_trimmed();
+    test_lookbehind();
+    test_distinct_identifiers();
+
+    return check_failures != 0;
+}
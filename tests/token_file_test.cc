@@ -0,0 +1,149 @@
+#include <TokenFile.h>
+#include <Tokenizer.h>
+#include "check.h"
+#include <unistd.h>
+
+#define SOURCE \
+    "// Every kind of token, with identifiers and values that show up more than once.\n" \
+    "const answer = 42, half = 1.5, big = 1e21, octal = 017, hex = 0x10;\n" \
+    "let name = 'it\\'s', other = \"two\", t = `a ${answer} b`;\n" \
+    "function f(a, b) { return a / b / 2; }\n" \
+    "if (answer === 42 && !false) { name = /ab+c/g.test(name) ? true : null; }\n" \
+    "for (let i = 0; i < answer; ++i) { f(i, half); }\n" \
+    "/* done */ export default f;\n"
+
+/**
+ * Writes bytes to a new temporary file.
+ * @return The name of the file, which the caller unlinks.
+ */
+static std::string write_temporary (const std::string& bytes) {
+    char file_name[] = "/tmp/m6_token_file_test_XXXXXX";
+    int fd = mkstemp(file_name);
+    CHECK(fd != -1);
+    CHECK(write(fd, bytes.data(), bytes.size()) == (ssize_t) bytes.size());
+    close(fd);
+    return file_name;
+}
+
+template <typename CharT>
+static err_t load (BasicTokenFile<CharT>& file, const std::string& bytes) {
+    std::string file_name = write_temporary(bytes);
+    err_t rv = file.load(file_name.c_str());
+    unlink(file_name.c_str());
+    return rv;
+}
+
+/**
+ * Tokenizes the source, writes it out as a token file, loads that back, and checks every record against the token
+ * it was written from.
+ * @return The bytes of the token file.
+ */
+template <typename CharT>
+static std::string test_round_trip (const std::basic_string<CharT>& source) {
+    BasicTokenizer<CharT> tokenizer(null_io_handler);
+    Result<BasicRootToken<CharT>> root = tokenizer.tokenize(source);
+    CHECK(root.ok());
+    if (!root) {
+        return "";
+    }
+
+    const std::string bytes = BasicTokenFile<CharT>::serialize(*root);
+
+    BasicTokenFile<CharT> file;
+    CHECK(load(file, bytes) == SUCCESS);
+    CHECK(file.get_content() == source);
+    CHECK(file.size() == root->token_vector.size());
+
+    size_t index = 0;
+    for (auto token: root->token_vector) {
+        if (index >= file.size()) {
+            break;
+        }
+
+        const token_file_record_t& record = file.get_record(index);
+        const token_value_t value = token.get_value();
+        CHECK(record.type == token.get_type());
+        CHECK(record.subtype == token.get_subtype());
+        CHECK(file.get_text(index) == token.get_text());
+        CHECK(file.next_sibling(index) == index + 1);
+
+        if (value.tag == IDENTIFIER_VALUE) {
+            CHECK(file.get_identifier(record.value) == token.get_text());
+        } else if (value.tag == NO_VALUE || value.tag == STRING_VALUE) {
+            CHECK(!(record.flags & TOKEN_FILE_HAS_VALUE));
+        } else {
+            CHECK(record.flags & TOKEN_FILE_HAS_VALUE);
+            CHECK(file.get_value(index) == value.bits);
+        }
+
+        ++index;
+    }
+
+    // Identifiers are interned, so "answer", "name", "f", "half" and "i" each have one entry.
+    CHECK(file.get_identifier_count() < index);
+
+    return bytes;
+}
+
+/**
+ * Checks that a token file that was cut short, or that has a header this build does not write, is rejected.
+ */
+template <typename CharT>
+static void test_rejected (const std::string& bytes) {
+    if (bytes.size() < sizeof(token_file_header_t)) {
+        return;  // The round trip already failed.
+    }
+
+    BasicTokenFile<CharT> file;
+
+    for (size_t size = 0; size < bytes.size(); size += 1 + size / 8) {
+        CHECK(load(file, bytes.substr(0, size)) == ERR_TOKEN_FILE_INVALID);
+    }
+    CHECK(load(file, bytes + std::string(8, '\0')) == ERR_TOKEN_FILE_INVALID);
+
+    const auto with_header = [&] (auto change) {
+        token_file_header_t header;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        change(header);
+        return std::string((const char*) &header, sizeof(header)) + bytes.substr(sizeof(header));
+    };
+
+    CHECK(load(file, with_header([] (token_file_header_t& h) { h.format_version++; })) == ERR_TOKEN_FILE_INVALID);
+    CHECK(load(file, with_header([] (token_file_header_t& h) { h.tokenizer_version++; })) == ERR_TOKEN_FILE_INVALID);
+    CHECK(load(file, with_header([] (token_file_header_t& h) { h.magic[0] = 'X'; })) == ERR_TOKEN_FILE_INVALID);
+    CHECK(load(file, with_header([] (token_file_header_t& h) { h.byte_order = 0x04'03'02'01; })) ==
+          ERR_TOKEN_FILE_INVALID);
+    CHECK(load(file, with_header([] (token_file_header_t& h) { h.token_count++; })) == ERR_TOKEN_FILE_INVALID);
+
+    // A token that ends past the content.
+    std::string out_of_bounds = bytes;
+    token_file_record_t record;
+    std::memcpy(&record, out_of_bounds.data() + sizeof(token_file_header_t), sizeof(record));
+    record.end = UINT32_MAX;
+    std::memcpy(out_of_bounds.data() + sizeof(token_file_header_t), &record, sizeof(record));
+    CHECK(load(file, out_of_bounds) == ERR_TOKEN_FILE_INVALID);
+
+    // The file loads again once it is whole.
+    CHECK(load(file, bytes) == SUCCESS);
+}
+
+int main () {
+    const std::string utf8 = SOURCE;
+    const std::u16string utf16 = u"" SOURCE;
+
+    const std::string utf8_bytes = test_round_trip(utf8);
+    const std::string utf16_bytes = test_round_trip(utf16);
+    test_rejected<char>(utf8_bytes);
+    test_rejected<char16_t>(utf16_bytes);
+
+    // A file of one code unit size is not loaded as the other.
+    Utf8TokenFile utf8_file;
+    TokenFile utf16_file;
+    CHECK(load(utf8_file, utf16_bytes) == ERR_TOKEN_FILE_INVALID);
+    CHECK(load(utf16_file, utf8_bytes) == ERR_TOKEN_FILE_INVALID);
+
+    // A file that does not exist.
+    CHECK(utf8_file.load("/nonexistent/file.m6t") == ERR_IFSTREAM_FAILED);
+
+    return check_failures != 0;
+}
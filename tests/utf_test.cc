@@ -0,0 +1,118 @@
+#include <utf.h>
+#include "check.h"
+
+// Long enough to span a few AVX2 blocks, so that every position lands at the start, middle and end of a block.
+#define MAX_SIZE 100
+
+/**
+ * The ASCII text that a test puts other code units into.
+ */
+static std::string ascii (const size_t size) {
+    std::string rv;
+    for (size_t i = 0; i < size; ++i) {
+        rv.push_back((char) (' ' + i % 95));
+    }
+    return rv;
+}
+
+/**
+ * Puts every encoded code point at every position of every ASCII text, and checks that it decodes to the code
+ * point and encodes back to the same bytes.
+ */
+static void test_round_trip () {
+    const char32_t code_points[] = {0xe9, 0x7ff, 0x800, 0x4e2d, 0xfffd, 0x1'f6'00, 0x10'ff'ff};
+
+    for (const char32_t code_point: code_points) {
+        std::string encoded;
+        append_code_point(code_point, encoded);
+
+        for (size_t size = 0; size <= MAX_SIZE; ++size) {
+            for (size_t at = 0; at <= size; ++at) {
+                std::string utf8 = ascii(size);
+                utf8.insert(at, encoded);
+
+                std::u16string expected;
+                for (size_t i = 0; i < at; ++i) {
+                    expected.push_back((char16_t) utf8[i]);
+                }
+                append_code_point(code_point, expected);
+                for (size_t i = at + encoded.size(); i < utf8.size(); ++i) {
+                    expected.push_back((char16_t) utf8[i]);
+                }
+
+                std::u16string utf16;
+                CHECK(utf8_to_utf16(utf8.data(), utf8.data() + utf8.size(), utf16) == NOT_FOUND);
+                CHECK(utf16 == expected);
+
+                std::string back;
+                CHECK(utf16_to_utf8(utf16.data(), utf16.data() + utf16.size(), back) == NOT_FOUND);
+                CHECK(back == utf8);
+            }
+        }
+    }
+}
+
+/**
+ * Puts every invalid UTF-8 sequence at every position of every ASCII text, and checks that its offset is reported,
+ * and that everything before it was decoded.
+ */
+static void test_invalid_utf8 () {
+    const std::string sequences[] = {
+            "\x80",  // A stray continuation byte.
+            "\xc0\x80",  // Overlong.
+            "\xe0\x80\x80",  // Overlong.
+            "\xed\xa0\x80",  // An encoded surrogate.
+            "\xf4\x90\x80\x80",  // Past U+10FFFF.
+            "\xff",
+            "\xe4\xb8",  // Truncated by the ASCII after it.
+    };
+
+    for (const auto& sequence: sequences) {
+        for (size_t size = 0; size <= MAX_SIZE; ++size) {
+            for (size_t at = 0; at <= size; ++at) {
+                std::string utf8 = ascii(size);
+                utf8.insert(at, sequence);
+
+                std::u16string utf16;
+                CHECK(utf8_to_utf16(utf8.data(), utf8.data() + utf8.size(), utf16) == (int64_t) at);
+                CHECK(utf16.size() == at);
+                CHECK(std::equal(utf16.begin(), utf16.end(), utf8.begin()));
+            }
+        }
+    }
+
+    // Truncated by the end of the input.
+    std::string utf8 = ascii(40) + "\xf0\x9f\x98";
+    std::u16string utf16;
+    CHECK(utf8_to_utf16(utf8.data(), utf8.data() + utf8.size(), utf16) == 40);
+}
+
+/**
+ * Puts every unpaired surrogate at every position of every ASCII text, and checks that its offset is reported,
+ * and that everything before it was encoded.
+ */
+static void test_invalid_utf16 () {
+    const std::u16string sequences[] = {u"\xd83d", u"\xde00", u"\xde00\xd83d"};
+
+    for (const auto& sequence: sequences) {
+        for (size_t size = 0; size <= MAX_SIZE; ++size) {
+            for (size_t at = 0; at <= size; ++at) {
+                std::string text = ascii(size);
+                std::u16string utf16(text.begin(), text.end());
+                utf16.insert(at, sequence);
+
+                std::string utf8;
+                CHECK(utf16_to_utf8(utf16.data(), utf16.data() + utf16.size(), utf8) == (int64_t) at);
+                CHECK(utf8 == text.substr(0, at));
+            }
+        }
+    }
+}
+
+int main () {
+    test_round_trip();
+    test_invalid_utf8();
+    test_invalid_utf16();
+
+    return check_failures != 0;
+}
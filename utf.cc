@@ -0,0 +1,340 @@
+#include <utf.h>
+#include <cstdlib>
+
+#if defined(__x86_64__) && defined(__SSE2__)
+#define UTF_X86
+#include <immintrin.h>
+#endif
+
+// Kernels convert the longest prefix of src that they can prove is ASCII, and return its length.
+// They may stop early (at a block boundary); the caller finishes any leftover code units one at a time.
+typedef size_t (* widen_kernel_t) (const uint8_t* src, size_t n, char16_t* dst);
+
+typedef size_t (* narrow_kernel_t) (const char16_t* src, size_t n, uint8_t* dst);
+
+[[maybe_unused]] static size_t widen_ascii_scalar (const uint8_t* src, const size_t n, char16_t* dst) {
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, src + i, 8);
+        if (word & 0x80'80'80'80'80'80'80'80u) {
+            break;
+        }
+        for (int j = 0; j < 8; ++j) {
+            dst[i + j] = src[i + j];
+        }
+    }
+
+    return i;
+}
+
+[[maybe_unused]] static size_t narrow_ascii_scalar (const char16_t* src, const size_t n, uint8_t* dst) {
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        uint64_t word;
+        std::memcpy(&word, src + i, 8);
+        if (word & 0xff'80'ff'80'ff'80'ff'80u) {
+            break;
+        }
+        for (int j = 0; j < 4; ++j) {
+            dst[i + j] = (uint8_t) src[i + j];
+        }
+    }
+
+    return i;
+}
+
+#ifdef UTF_X86
+
+static size_t widen_ascii_sse2 (const uint8_t* src, const size_t n, char16_t* dst) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*) (src + i));
+        if (_mm_movemask_epi8(v)) {
+            break;
+        }
+        _mm_storeu_si128((__m128i*) (dst + i), _mm_unpacklo_epi8(v, zero));
+        _mm_storeu_si128((__m128i*) (dst + i + 8), _mm_unpackhi_epi8(v, zero));
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t widen_ascii_avx2 (const uint8_t* src, const size_t n, char16_t* dst) {
+    size_t i = 0;
+
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*) (src + i));
+        if (_mm256_movemask_epi8(v)) {
+            break;
+        }
+        _mm256_storeu_si256((__m256i*) (dst + i), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)));
+        _mm256_storeu_si256((__m256i*) (dst + i + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)));
+    }
+
+    return i;
+}
+
+static size_t narrow_ascii_sse2 (const char16_t* src, const size_t n, uint8_t* dst) {
+    const __m128i non_ascii = _mm_set1_epi16((short) 0xff80);
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i*) (src + i));
+        __m128i b = _mm_loadu_si128((const __m128i*) (src + i + 8));
+        __m128i high_bits = _mm_and_si128(_mm_or_si128(a, b), non_ascii);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(high_bits, zero)) != 0xffff) {
+            break;
+        }
+        _mm_storeu_si128((__m128i*) (dst + i), _mm_packus_epi16(a, b));
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t narrow_ascii_avx2 (const char16_t* src, const size_t n, uint8_t* dst) {
+    const __m256i non_ascii = _mm256_set1_epi16((short) 0xff80);
+    size_t i = 0;
+
+    for (; i + 32 <= n; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i*) (src + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*) (src + i + 16));
+        if (!_mm256_testz_si256(_mm256_or_si256(a, b), non_ascii)) {
+            break;
+        }
+        // packus works per 128-bit lane, so the 64-bit quarters come out as a0 b0 a1 b1 and need reordering.
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i*) (dst + i), packed);
+    }
+
+    return i;
+}
+
+#endif
+
+// Whether the AVX2 kernels can be used. Setting M6_DISABLE_AVX2 in the environment falls back to the SSE2 ones,
+// so that both can be tested on the same machine.
+[[maybe_unused]] static bool use_avx2 () {
+#ifdef UTF_X86
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && std::getenv("M6_DISABLE_AVX2") == nullptr;
+#else
+    return false;
+#endif
+}
+
+static widen_kernel_t select_widen_kernel () {
+#ifdef UTF_X86
+    if (use_avx2()) {
+        return widen_ascii_avx2;
+    }
+    return widen_ascii_sse2;
+#else
+    return widen_ascii_scalar;
+#endif
+}
+
+static narrow_kernel_t select_narrow_kernel () {
+#ifdef UTF_X86
+    if (use_avx2()) {
+        return narrow_ascii_avx2;
+    }
+    return narrow_ascii_sse2;
+#else
+    return narrow_ascii_scalar;
+#endif
+}
+
+// The kernels are picked on first use rather than during static initialization, so that a static initializer in
+// another translation unit can transcode before this one has been initialized.
+static size_t widen_ascii (const uint8_t* const src, const size_t n, char16_t* const dst) {
+    static const widen_kernel_t kernel = select_widen_kernel();
+    return kernel(src, n, dst);
+}
+
+static size_t narrow_ascii (const char16_t* const src, const size_t n, uint8_t* const dst) {
+    static const narrow_kernel_t kernel = select_narrow_kernel();
+    return kernel(src, n, dst);
+}
+
+/**
+ * Decodes UTF-8 into UTF-16. A UTF-8 input never needs more UTF-16 code units than it has bytes,
+ * so the result is sized once up front and trimmed at the end.
+ * @param begin
+ * @param end
+ * @param result
+ * @return NOT_FOUND, or the byte offset of the first invalid sequence.
+ */
+int64_t utf8_to_utf16 (const char* const begin, const char* const end, std::u16string& result) {
+    auto src = (const uint8_t*) begin;
+    const size_t n = end - begin;
+
+    result.resize(n);
+    char16_t* const out_begin = result.data();
+    char16_t* out = out_begin;
+
+    size_t i = 0;
+    while (i < n) {
+        if (src[i] < 0x80) {
+            size_t run = widen_ascii(src + i, n - i, out);
+            i += run;
+            out += run;
+
+            // Finish the ASCII run up to the next multi-byte sequence (or the end).
+            while (i < n && src[i] < 0x80) {
+                *out++ = src[i++];
+            }
+            continue;
+        }
+
+        uint8_t c = src[i];
+        uint32_t code_point;
+        uint8_t length;
+        uint8_t lower = 0x80, upper = 0xbf;  // Allowed range of the second byte.
+
+        if (c < 0xc2) {  // Stray continuation byte, or an overlong two byte form.
+            goto invalid;
+        } else if (c < 0xe0) {
+            length = 2;
+            code_point = c & 0x1fu;
+        } else if (c < 0xf0) {
+            length = 3;
+            code_point = c & 0x0fu;
+            if (c == 0xe0) lower = 0xa0;  // Overlong.
+            if (c == 0xed) upper = 0x9f;  // Surrogates.
+        } else if (c < 0xf5) {
+            length = 4;
+            code_point = c & 0x07u;
+            if (c == 0xf0) lower = 0x90;  // Overlong.
+            if (c == 0xf4) upper = 0x8f;  // Past U+10FFFF.
+        } else {
+            goto invalid;
+        }
+
+        if (n - i < length || src[i + 1] < lower || src[i + 1] > upper) {
+            goto invalid;
+        }
+
+        for (uint8_t j = 1; j < length; ++j) {
+            if ((src[i + j] & 0xc0u) != 0x80) {
+                goto invalid;
+            }
+            code_point = (code_point << 6u) | (src[i + j] & 0x3fu);
+        }
+
+        if (code_point >= 0x1'00'00) {
+            code_point -= 0x1'00'00;
+            *out++ = (char16_t) (0xd800 | (code_point >> 10u));
+            *out++ = (char16_t) (0xdc00 | (code_point & 0x3ffu));
+        } else {
+            *out++ = (char16_t) code_point;
+        }
+
+        i += length;
+    }
+
+    result.resize(out - out_begin);
+    return NOT_FOUND;
+
+    invalid:
+    result.resize(out - out_begin);
+    return (int64_t) i;
+}
+
+/**
+ * Encodes UTF-16 into UTF-8. A UTF-16 code unit never needs more than three bytes (pairs need four for two),
+ * so the result is sized once up front and trimmed at the end.
+ * @param begin
+ * @param end
+ * @param result
+ * @return NOT_FOUND, or the code unit offset of the first unpaired surrogate.
+ */
+int64_t utf16_to_utf8 (const char16_t* const begin, const char16_t* const end, std::string& result) {
+    const size_t n = end - begin;
+
+    result.resize(3 * n);
+    auto const out_begin = (uint8_t*) result.data();
+    uint8_t* out = out_begin;
+
+    size_t i = 0;
+    while (i < n) {
+        char16_t c = begin[i];
+
+        if (c < 0x80) {
+            size_t run = narrow_ascii(begin + i, n - i, out);
+            i += run;
+            out += run;
+
+            while (i < n && begin[i] < 0x80) {
+                *out++ = (uint8_t) begin[i++];
+            }
+            continue;
+        }
+
+        if (c < 0x8'00) {
+            *out++ = 0xc0 | (c >> 6u);
+            *out++ = 0x80 | (c & 0x3fu);
+            ++i;
+            continue;
+        }
+
+        if (c < 0xd8'00 || c > 0xdf'ff) {
+            *out++ = 0xe0 | (c >> 12u);
+            *out++ = 0x80 | ((c >> 6u) & 0x3fu);
+            *out++ = 0x80 | (c & 0x3fu);
+            ++i;
+            continue;
+        }
+
+        // A high surrogate followed by a low surrogate is the only valid use of the surrogate range.
+        if (c > 0xdb'ff || i + 1 == n || begin[i + 1] < 0xdc'00 || begin[i + 1] > 0xdf'ff) {
+            result.resize(out - out_begin);
+            return (int64_t) i;
+        }
+
+        uint32_t code_point = 0x1'00'00 + (((c & 0x3ffu) << 10u) | (begin[i + 1] & 0x3ffu));
+        *out++ = 0xf0 | (code_point >> 18u);
+        *out++ = 0x80 | ((code_point >> 12u) & 0x3fu);
+        *out++ = 0x80 | ((code_point >> 6u) & 0x3fu);
+        *out++ = 0x80 | (code_point & 0x3fu);
+        i += 2;
+    }
+
+    result.resize(out - out_begin);
+    return NOT_FOUND;
+}
+
+void append_code_point (const char32_t code_point, std::u16string& result) {
+    if (code_point < 0x1'00'00) {
+        result.push_back((char16_t) code_point);
+        return;
+    }
+
+    result.push_back((char16_t) (0xd8'00 | ((code_point - 0x1'00'00) >> 10u)));
+    result.push_back((char16_t) (0xdc'00 | (code_point & 0x3ffu)));
+}
+
+void append_code_point (const char32_t code_point, std::string& result) {
+    if (code_point < 0x80) {
+        result.push_back((char) code_point);
+    } else if (code_point < 0x8'00) {
+        result.push_back((char) (0xc0 | (code_point >> 6u)));
+        result.push_back((char) (0x80 | (code_point & 0x3fu)));
+    } else if (code_point < 0x1'00'00) {
+        result.push_back((char) (0xe0 | (code_point >> 12u)));
+        result.push_back((char) (0x80 | ((code_point >> 6u) & 0x3fu)));
+        result.push_back((char) (0x80 | (code_point & 0x3fu)));
+    } else {
+        result.push_back((char) (0xf0 | (code_point >> 18u)));
+        result.push_back((char) (0x80 | ((code_point >> 12u) & 0x3fu)));
+        result.push_back((char) (0x80 | ((code_point >> 6u) & 0x3fu)));
+        result.push_back((char) (0x80 | (code_point & 0x3fu)));
+    }
+}